@@ -1,31 +1,213 @@
 #include "syntacts.h"
 #include <syntacts>
-#include <unordered_map>
 #include <iostream>
+#include <future>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
 
 using namespace tact;
 
-std::unordered_map<Handle, Signal> g_sigs;
-std::unordered_map<Handle, std::unique_ptr<Session>> g_sessions;
-std::unordered_map<Handle, std::unique_ptr<Spatializer>> g_spats;
+/// Thread-safe table of objects addressed by C API Handles. A Handle encodes a slot index
+/// and the slot's generation, so stale Handles (deleted objects) fail lookups instead of
+/// aliasing a newer object, and 0 is never a valid Handle. Objects are constructed in place
+/// in fixed size pages which never move, so lookups are lock-free and O(1). Creation and
+/// deletion lock only to take or return a free slot. Deleting a Handle while another thread
+/// is still using it remains an error on the caller's part.
+template <typename T>
+class SlotMap {
+public:
+    SlotMap() { }
+    SlotMap(const SlotMap&) = delete;
+    SlotMap& operator=(const SlotMap&) = delete;
+
+    ~SlotMap() {
+        clear();
+        for (auto& page : m_pages)
+            delete[] page.load();
+    }
+
+    /// Constructs a new object, returning its Handle (or nullptr if the table is full or T's constructor throws).
+    template <typename... Args>
+    Handle emplace(Args&&... args) {
+        std::uint32_t index;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_free.empty()) {
+                index = m_free.back();
+                m_free.pop_back();
+            }
+            else {
+                if (m_next == CAPACITY)
+                    return nullptr;
+                index = m_next++;
+                if (index % PAGE_SIZE == 0)
+                    m_pages[index / PAGE_SIZE].store(new Slot[PAGE_SIZE], std::memory_order_release);
+            }
+        }
+        Slot& slot = m_pages[index / PAGE_SIZE].load(std::memory_order_relaxed)[index % PAGE_SIZE];
+        try {
+            new (&slot.storage) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_free.push_back(index);
+            return nullptr;
+        }
+        // an odd generation marks the slot occupied; publishing it makes the object visible to lookups
+        std::uint32_t gen = slot.generation.load(std::memory_order_relaxed) + 1;
+        slot.generation.store(gen, std::memory_order_release);
+        m_size.fetch_add(1, std::memory_order_relaxed);
+        return encode(index, gen);
+    }
+
+    /// Returns the object for a Handle, or nullptr if the Handle is invalid or stale.
+    T* get(Handle h) const {
+        Slot* slot = find(h);
+        return slot ? slot->object() : nullptr;
+    }
+
+    /// Returns true if the Handle refers to a live object.
+    bool valid(Handle h) const {
+        return find(h) != nullptr;
+    }
+
+    /// Destroys the object for a Handle. Returns false if the Handle is invalid or stale.
+    bool erase(Handle h) {
+        Slot* slot = find(h);
+        if (!slot)
+            return false;
+        // claim the slot by making its generation even; of concurrent erases only one succeeds
+        std::uint32_t gen = slot->generation.load(std::memory_order_relaxed);
+        if (!(gen & 1) || (gen & GEN_MASK) != generation(h) ||
+            !slot->generation.compare_exchange_strong(gen, gen + 1, std::memory_order_acq_rel))
+            return false;
+        slot->object()->~T();
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(index(h));
+        return true;
+    }
+
+    /// Destroys all objects.
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::uint32_t i = 0; i < m_next; ++i) {
+            Slot& slot = m_pages[i / PAGE_SIZE].load(std::memory_order_relaxed)[i % PAGE_SIZE];
+            std::uint32_t gen = slot.generation.load(std::memory_order_relaxed);
+            if ((gen & 1) && slot.generation.compare_exchange_strong(gen, gen + 1, std::memory_order_acq_rel)) {
+                slot.object()->~T();
+                m_size.fetch_sub(1, std::memory_order_relaxed);
+                m_free.push_back(i);
+            }
+        }
+    }
+
+    /// Returns the number of live objects.
+    std::size_t size() const {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::uint32_t> generation{0}; ///< odd while occupied
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        T* object() { return std::launder(reinterpret_cast<T*>(&storage)); }
+    };
+
+    // half of the Handle bits index the slot, the other half hold its generation
+    static constexpr int           INDEX_BITS = sizeof(std::uintptr_t) * 4;
+    static constexpr std::uint32_t INDEX_MASK = static_cast<std::uint32_t>((std::uintptr_t(1) << INDEX_BITS) - 1);
+    static constexpr std::uint32_t GEN_MASK   = INDEX_MASK;
+    static constexpr std::uint32_t PAGE_SIZE  = 1024;
+    static constexpr std::uint32_t MAX_PAGES  = std::min<std::uint32_t>(4096, (INDEX_MASK / PAGE_SIZE) + 1);
+    static constexpr std::uint32_t CAPACITY   = MAX_PAGES * PAGE_SIZE;
+
+    static Handle encode(std::uint32_t index, std::uint32_t gen) {
+        return reinterpret_cast<Handle>((static_cast<std::uintptr_t>(gen & GEN_MASK) << INDEX_BITS) | index);
+    }
+
+    static std::uint32_t index(Handle h) {
+        return static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(h) & INDEX_MASK);
+    }
+
+    static std::uint32_t generation(Handle h) {
+        return static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(h) >> INDEX_BITS) & GEN_MASK;
+    }
+
+    Slot* find(Handle h) const {
+        std::uint32_t i = index(h), gen = generation(h);
+        if (!(gen & 1) || i >= CAPACITY)
+            return nullptr;
+        Slot* page = m_pages[i / PAGE_SIZE].load(std::memory_order_acquire);
+        if (!page)
+            return nullptr;
+        Slot& slot = page[i % PAGE_SIZE];
+        if ((slot.generation.load(std::memory_order_acquire) & GEN_MASK) != gen)
+            return nullptr;
+        return &slot;
+    }
+
+    std::atomic<Slot*>         m_pages[MAX_PAGES] = {};
+    std::mutex                 m_mutex;
+    std::vector<std::uint32_t> m_free;
+    std::uint32_t              m_next = 0;
+    std::atomic<std::size_t>   m_size{0};
+};
+
+SlotMap<Signal>      g_sigs;
+SlotMap<Session>     g_sessions;
+SlotMap<Spatializer> g_spats;
 
 struct Finalizer {
     ~Finalizer()
     { 
-        g_sigs.clear();
-        g_sessions.clear(); 
         g_spats.clear();
+        g_sessions.clear(); 
+        g_sigs.clear();
     }
 };
 
 Finalizer g_finalizer;
 
+/// Looks up the object for a Handle into var, returning fallback from the calling function if the
+/// Handle is invalid or stale. Exceptions must not cross the C API, so entry points use this instead of throwing.
+#define TACT_LOOKUP(var, map, handle, fallback) \
+    auto var = map.get(handle);                 \
+    if (!var)                                   \
+        return fallback
+
+/// Returns a device available to a Session, or nullptr if the Session or device index is invalid
+inline const Device* findDevice(Handle session, int d) {
+    TACT_LOOKUP(sess, g_sessions, session, nullptr);
+    auto& devs = sess->getAvailableDevices();
+    auto it = devs.find(d);
+    return it == devs.end() ? nullptr : &it->second;
+}
+
+inline Voice encode(const VoiceId& v) {
+    if (v.error != SyntactsError_NoError)
+        return v.error;
+    return (static_cast<Voice>(v.channel) << 32) | v.id;
+}
+
+inline VoiceId decode(Voice v) {
+    VoiceId id;
+    if (v < 0) {
+        id.error = static_cast<int>(v);
+        return id;
+    }
+    id.channel = static_cast<int>(v >> 32);
+    id.id      = static_cast<std::uint32_t>(v & 0xFFFFFFFF);
+    return id;
+}
+
 template <typename S>
 inline Handle store(const S& s) {
-    Signal sig(s);
-    Handle h = sig.get();
-    g_sigs.emplace(h, std::move(sig));
-    return h;
+    return g_sigs.emplace(s);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -57,10 +239,7 @@ int Syntacts_maxVoices() {
 ///////////////////////////////////////////////////////////////////////////////
 
 Handle Session_create() {
-    std::unique_ptr session = std::make_unique<Session>();
-    Handle h = static_cast<Handle>(session.get());
-    g_sessions.emplace(h, std::move(session));
-    return h;
+    return g_sessions.emplace();
 }
 
 void Session_delete(Handle session) {
@@ -68,126 +247,332 @@ void Session_delete(Handle session) {
 }
 
 bool Session_valid(Handle session) {
-    return g_sessions.count(session) > 0;
+    return g_sessions.valid(session);
 }
 
 int Session_open1(Handle session) {
-    return static_cast<Session*>(session)->open();
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->open();
 }
 
 int Session_open2(Handle session, int index) {
-    return static_cast<Session*>(session)->open(index);
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->open(index);
 }
 
 int Session_open3(Handle session, int index, int channelCount, double sampleRate) {
-    return static_cast<Session*>(session)->open(index, channelCount, sampleRate);
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->open(index, channelCount, sampleRate);
 }
 
 int Session_open4(Handle session, int api) {
-    return static_cast<Session*>(session)->open(static_cast<API>(api));
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->open(static_cast<API>(api));
 }
 
 int Session_open5(Handle session, char* name, int api) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
     std::string name_str(name);
-    return static_cast<Session*>(session)->open(name_str, static_cast<API>(api));
+    return sess->open(name_str, static_cast<API>(api));
+}
+
+int Session_open6(Handle session, int index, int channelCount, double sampleRate, int framesPerBuffer, double latency) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->open(index, channelCount, sampleRate, framesPerBuffer, latency);
+}
+
+int Session_openJack(Handle session, int channelCount, char* clientName, bool connect) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    std::string name_str(clientName);
+    return sess->openJack(channelCount, name_str, connect);
+}
+
+int Session_openOffline(Handle session, int channelCount, double sampleRate) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->openOffline(channelCount, sampleRate);
+}
+
+int Session_render(Handle session, float* buffer, int frames) {
+    // buffer holds frames of channel 0, then frames of channel 1, etc.
+    TACT_LOOKUP(s, g_sessions, session, SyntactsError_InvalidHandle);
+    std::vector<float*> buffers(s->getChannelCount());
+    for (std::size_t c = 0; c < buffers.size(); ++c)
+        buffers[c] = buffer + c * frames;
+    return s->render(buffers.data(), frames);
 }
 
 
 int Session_close(Handle session) {
-    return static_cast<Session*>(session)->close();
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->close();
 }
 
 bool Session_isOpen(Handle session) {
-    return static_cast<Session*>(session)->isOpen();
+    TACT_LOOKUP(sess, g_sessions, session, false);
+    return sess->isOpen();
 }
 
 int Session_play(Handle session, int channel, Handle signal) {
-    return static_cast<Session*>(session)->play(channel, g_sigs.at(signal));
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    TACT_LOOKUP(sig, g_sigs, signal, SyntactsError_InvalidHandle);
+    return sess->play(channel, *sig);
+}
+
+int Session_play2(Handle session, int channel, Handle signal, int priority) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    TACT_LOOKUP(sig, g_sigs, signal, SyntactsError_InvalidHandle);
+    return sess->play(channel, *sig, priority);
+}
+
+Voice Session_playVoice(Handle session, int channel, Handle signal, int priority) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    TACT_LOOKUP(sig, g_sigs, signal, SyntactsError_InvalidHandle);
+    return encode(sess->play(channel, *sig, priority));
+}
+
+int Session_stopVoice(Handle session, Voice voice) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->stop(decode(voice));
+}
+
+int Session_setVoiceVolume(Handle session, Voice voice, double volume) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->setVolume(decode(voice), volume);
+}
+
+int Session_setVoicePitch(Handle session, Voice voice, double pitch) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->setPitch(decode(voice), pitch);
+}
+
+bool Session_isVoicePlaying(Handle session, Voice voice) {
+    TACT_LOOKUP(sess, g_sessions, session, false);
+    return sess->isPlaying(decode(voice));
+}
+
+double Session_getVoiceTime(Handle session, Voice voice) {
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getTime(decode(voice));
 }
 
 int Session_playAll(Handle session, Handle signal) {
-    return static_cast<Session*>(session)->playAll(g_sigs.at(signal));
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    TACT_LOOKUP(sig, g_sigs, signal, SyntactsError_InvalidHandle);
+    return sess->playAll(*sig);
 }
 
 int Session_stop(Handle session, int channel) {
-    return static_cast<Session*>(session)->stop(channel);
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->stop(channel);
 }
 
 int Session_stopAll(Handle session) {
-    return static_cast<Session*>(session)->stopAll();
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->stopAll();
 }
 
 int Session_pause(Handle session, int channel) {
-    return static_cast<Session*>(session)->pause(channel);
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->pause(channel);
 }
 
 int Session_pauseAll(Handle session) {
-    return static_cast<Session*>(session)->pauseAll();
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->pauseAll();
 }
 
 int Session_resume(Handle session, int channel) {
-    return static_cast<Session*>(session)->resume(channel);
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->resume(channel);
 }
 
 int Session_resumeAll(Handle session) {
-    return static_cast<Session*>(session)->resumeAll();
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->resumeAll();
 }
 
 bool Session_isPlaying(Handle session, int channel) {
-    return static_cast<Session*>(session)->isPlaying(channel);
+    TACT_LOOKUP(sess, g_sessions, session, false);
+    return sess->isPlaying(channel);
 }
 
 bool Session_isPaused(Handle session, int channel) {
-    return static_cast<Session*>(session)->isPaused(channel);
+    TACT_LOOKUP(sess, g_sessions, session, false);
+    return sess->isPaused(channel);
 }
 
 int Session_setVolume(Handle session, int channel, double volume) {
-    return static_cast<Session*>(session)->setVolume(channel, volume);
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->setVolume(channel, volume);
+}
+
+int Session_setVolumes(Handle session, const int* channels, const double* volumes, int count) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->setVolumes(std::vector<int>(channels, channels + count), std::vector<double>(volumes, volumes + count));
 }
 
 double Session_getVolume(Handle session, int channel) {
-    return static_cast<Session*>(session)->getVolume(channel);
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getVolume(channel);
 }
 
 int Session_setPitch(Handle session, int channel, double pitch) {
-    return static_cast<Session*>(session)->setPitch(channel, pitch);
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->setPitch(channel, pitch);
 }
 
 double Session_getPitch(Handle session, int channel) {
-    return static_cast<Session*>(session)->getPitch(channel);
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getPitch(channel);
 }
 
 double Session_getLevel(Handle session, int channel) {
-    return static_cast<Session*>(session)->getLevel(channel);
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getLevel(channel);
+}
+
+int Session_setMaxVoices(Handle session, int voices) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->setMaxVoices(voices);
+}
+
+int Session_getMaxVoices(Handle session) {
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getMaxVoices();
+}
+
+int Session_getVoiceCount(Handle session, int channel) {
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getVoiceCount(channel);
+}
+
+void Session_setVoiceStealing(Handle session, int policy) {
+    TACT_LOOKUP(sess, g_sessions, session, );
+    sess->setVoiceStealing(static_cast<VoiceStealing>(policy));
+}
+
+int Session_getVoiceStealing(Handle session) {
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return static_cast<int>(sess->getVoiceStealing());
+}
+
+int Session_setOutputStage(Handle session, int channel, bool dcBlocker, double dcCutoff, bool eq, double eqFrequency, double eqGain, double eqQ, bool limiter, double threshold, double lookAhead, double release, bool softClip) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    OutputStage stage;
+    stage.dcBlocker   = dcBlocker;
+    stage.dcCutoff    = dcCutoff;
+    stage.eq          = eq;
+    stage.eqFrequency = eqFrequency;
+    stage.eqGain      = eqGain;
+    stage.eqQ         = eqQ;
+    stage.limiter     = limiter;
+    stage.threshold   = threshold;
+    stage.lookAhead   = lookAhead;
+    stage.release     = release;
+    stage.softClip    = softClip;
+    return sess->setOutputStage(channel, stage);
+}
+
+int Session_setFadeTime(Handle session, double seconds) {
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->setFadeTime(seconds);
+}
+
+double Session_getFadeTime(Handle session) {
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getFadeTime();
 }
 
 int Session_getChannelCount(Handle session) {
-    return static_cast<Session*>(session)->getChannelCount();
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getChannelCount();
 }
 
 double Session_getSampleRate(Handle session) {
-    return static_cast<Session*>(session)->getSampleRate();
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getSampleRate();
 }
 
 double Session_getCpuLoad(Handle session) {
-    return static_cast<Session*>(session)->getCpuLoad();
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getCpuLoad();
+}
+
+double Session_getLatency(Handle session) {
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getLatency();
+}
+
+double Session_getTime(Handle session) {
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getTime();
+}
+
+void Session_getCallbackStats(Handle session, int channel, double* mean, double* max, long long* counts) {
+    TACT_LOOKUP(sess, g_sessions, session, );
+    // channel -1 gets the whole callback, counts (if not null) must hold Histogram::Bins values
+    auto stats = sess->getStats();
+    Histogram h;
+    if (channel == -1)
+        h = stats.callback;
+    else if (channel >= 0 && channel < static_cast<int>(stats.channels.size()))
+        h = stats.channels[channel];
+    *mean = h.mean;
+    *max  = h.max;
+    if (counts) {
+        for (int i = 0; i < Histogram::Bins; ++i)
+            counts[i] = static_cast<long long>(h.counts[i]);
+    }
+}
+
+int Session_getQueueDepth(Handle session) {
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getStats().queueDepth;
+}
+
+int Session_getQueueDepthMax(Handle session) {
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return sess->getStats().queueDepthMax;
+}
+
+long long Session_getXrunCount(Handle session) {
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return static_cast<long long>(sess->getStats().xruns);
+}
+
+int Session_getXrunTimes(Handle session, double* times, int maxCount) {
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    auto stats = sess->getStats();
+    int n = std::max(0, std::min(maxCount, static_cast<int>(stats.xrunTimes.size())));
+    // most recent n, oldest first
+    std::copy(stats.xrunTimes.end() - n, stats.xrunTimes.end(), times);
+    return n;
+}
+
+void Session_resetStats(Handle session) {
+    TACT_LOOKUP(sess, g_sessions, session, );
+    sess->resetStats();
 }
 
 int Session_getCurrentDevice(Handle session) {
-    return static_cast<Session*>(session)->getCurrentDevice().index;
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->getCurrentDevice().index;
 }
 
 int Session_getDefaultDevice(Handle session) {
-    return static_cast<Session*>(session)->getDefaultDevice().index;
+    TACT_LOOKUP(sess, g_sessions, session, SyntactsError_InvalidHandle);
+    return sess->getDefaultDevice().index;
 }
 
 int Session_getAvailableDevicesCount(Handle session) {
-    return static_cast<int>(static_cast<Session*>(session)->getAvailableDevices().size());
+    TACT_LOOKUP(sess, g_sessions, session, 0);
+    return static_cast<int>(sess->getAvailableDevices().size());
 }
 
 void Session_getAvailableDevices(Handle session, int* devices) {
+    TACT_LOOKUP(sess, g_sessions, session, );
     int i = 0; 
-    for (auto& dev : static_cast<Session*>(session)->getAvailableDevices()) {
+    for (auto& dev : sess->getAvailableDevices()) {
         devices[i++] = dev.second.index;
     }
 }
@@ -199,78 +584,93 @@ int Session_count() {
 ///////////////////////////////////////////////////////////////////////////////
 
 int  Device_nameLength(Handle session, int d) {
-    auto& devs = static_cast<Session*>(session)->getAvailableDevices();
-    return (int)devs.at(d).name.length();
+    auto dev = findDevice(session, d);
+    if (!dev)
+        return 0;
+    return (int)dev->name.length();
 }
 
 void Device_name(Handle session, int d, char* buf) {
-    auto& devs = static_cast<Session*>(session)->getAvailableDevices();
-    auto& name = devs.at(d).name;
+    auto dev = findDevice(session, d);
+    if (!dev)
+        return;
+    auto& name = dev->name;
     name.copy(buf, name.length());
     buf[name.length()] = '\0';
 }
 
 bool Device_isDefault(Handle session, int d) {
-    auto& devs = static_cast<Session*>(session)->getAvailableDevices();
-    return devs.at(d).isDefault;
+    auto dev = findDevice(session, d);
+    if (!dev)
+        return false;
+    return dev->isDefault;
 }
 
 int  Device_api(Handle session, int d) {
-    auto& devs = static_cast<Session*>(session)->getAvailableDevices();
-    return static_cast<int>(devs.at(d).api);
+    auto dev = findDevice(session, d);
+    if (!dev)
+        return 0;
+    return static_cast<int>(dev->api);
 }
 
 int  Device_apiNameLength(Handle session, int d) {
-    auto& devs = static_cast<Session*>(session)->getAvailableDevices();
-    return (int)devs.at(d).apiName.length();
+    auto dev = findDevice(session, d);
+    if (!dev)
+        return 0;
+    return (int)dev->apiName.length();
 }
 
 void Device_apiName(Handle session, int d, char* buf) {
-    auto& devs = static_cast<Session*>(session)->getAvailableDevices();
-    auto& name = devs.at(d).apiName;
+    auto dev = findDevice(session, d);
+    if (!dev)
+        return;
+    auto& name = dev->apiName;
     name.copy(buf, name.length());
     buf[name.length()] = '\0';
 }
 
 bool Device_isApiDefault(Handle session, int d) {
-    auto& devs = static_cast<Session*>(session)->getAvailableDevices();
-    return devs.at(d).isApiDefault;
+    auto dev = findDevice(session, d);
+    if (!dev)
+        return false;
+    return dev->isApiDefault;
 }
 
 int  Device_maxChannels(Handle session, int d) {
-    auto& devs = static_cast<Session*>(session)->getAvailableDevices();
-    return devs.at(d).maxChannels;
+    auto dev = findDevice(session, d);
+    if (!dev)
+        return 0;
+    return dev->maxChannels;
 }
 
 int  Device_sampleRatesCount(Handle session, int d) {
-    auto& devs = static_cast<Session*>(session)->getAvailableDevices();
-    return (int)devs.at(d).sampleRates.size();
+    auto dev = findDevice(session, d);
+    if (!dev)
+        return 0;
+    return (int)dev->sampleRates.size();
 }
 
 void Device_sampleRates(Handle session, int d, int* sampleRates) {
-    auto& devs = static_cast<Session*>(session)->getAvailableDevices();
-    auto& srs = devs.at(d).sampleRates;
+    auto dev = findDevice(session, d);
+    if (!dev)
+        return;
+    auto& srs = dev->sampleRates;
     for (int i = 0; i < srs.size(); ++i)
         sampleRates[i] = srs[i];
 }
 
 int  Device_defaultSampleRate(Handle session, int d) {
-    auto& devs = static_cast<Session*>(session)->getAvailableDevices();
-    return devs.at(d).defaultSampleRate;
+    auto dev = findDevice(session, d);
+    if (!dev)
+        return 0;
+    return dev->defaultSampleRate;
 }
 
 
 ///////////////////////////////////////////////////////////////////////////////
 
 Handle Spatializer_create(Handle session) {
-    std::unique_ptr<Spatializer> spat;
-    if (g_sessions.count(session)) 
-        spat = std::make_unique<Spatializer>(static_cast<Session*>(session));
-    else
-        spat = std::make_unique<Spatializer>();
-    Handle h = static_cast<Handle>(spat.get());
-    g_spats.emplace(h, std::move(spat));    
-    return h;
+    return g_spats.emplace(g_sessions.get(session));
 }
 
 void Spatializer_delete(Handle spat) {
@@ -278,61 +678,73 @@ void Spatializer_delete(Handle spat) {
 }
 
 bool Spatializer_valid(Handle spat) {
-    return g_spats.count(spat) > 0;
+    return g_spats.valid(spat);
 }
 
 void Spatializer_bind(Handle spat, Handle session) {
-    static_cast<Spatializer*>(spat)->bind(static_cast<Session*>(session));
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->bind(g_sessions.get(session));
 }
 
 void Spatializer_unbind(Handle spat) {
-    static_cast<Spatializer*>(spat)->unbind();
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->unbind();
 }
 
 void Spatializer_setPosition(Handle spat, int channel, double x, double y) {
-    static_cast<Spatializer*>(spat)->setPosition(channel, x, y);
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->setPosition(channel, x, y);
 }
 
 void Spatializer_getPosition(Handle spat, int channel, double* x, double* y) {
-    auto p = static_cast<Spatializer*>(spat)->getPosition(channel);
+    TACT_LOOKUP(sp, g_spats, spat, );
+    auto p = sp->getPosition(channel);
     *x = p.x;
     *y = p.y;
 }
 
 void Spatializer_setTarget(Handle spat, double x, double y) {
-    static_cast<Spatializer*>(spat)->setTarget(x,y);
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->setTarget(x,y);
 }
 
 void Spatializer_getTarget(Handle spat, double* x, double* y) {
-    auto p = static_cast<Spatializer*>(spat)->getTarget();
+    TACT_LOOKUP(sp, g_spats, spat, );
+    auto p = sp->getTarget();
     *x = p.x;
     *y = p.y;
 }
 
 void Spatializer_setRadius(Handle spat, double r) {
-    static_cast<Spatializer*>(spat)->setRadius(r);
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->setRadius(r);
 }
 
 double Spatializer_getRadius(Handle spat) {
-    return static_cast<Spatializer*>(spat)->getRadius();
+    TACT_LOOKUP(sp, g_spats, spat, 0);
+    return sp->getRadius();
 }
 
 // 0 = lin, 1 = smooth, 2 = smoother, 3 = smoothest, 4 = log, 5 = exp
-void Spatializer_setRollOff(Handle spat, int type) {
-    auto sp = static_cast<Spatializer*>(spat);
+Curve rollOffCurve(int type) {
     switch (type) {
-        case 0: sp->setRollOff(Curves::Linear()); break;
-        case 1: sp->setRollOff(Curves::Smoothstep()); break;
-        case 2: sp->setRollOff(Curves::Smootherstep()); break;
-        case 3: sp->setRollOff(Curves::Smootheststep()); break;
-        case 4: sp->setRollOff(Curves::Exponential::In()); break;
-        case 5: sp->setRollOff(Curves::Exponential::Out()); break;
-        default: sp->setRollOff(Curves::Linear()); break;
+        case 0: return Curves::Linear();
+        case 1: return Curves::Smoothstep();
+        case 2: return Curves::Smootherstep();
+        case 3: return Curves::Smootheststep();
+        case 4: return Curves::Exponential::In();
+        case 5: return Curves::Exponential::Out();
+        default: return Curves::Linear();
     }
+}
+
+void Spatializer_setRollOff(Handle spat, int type) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->setRollOff(rollOffCurve(type));
 } 
 
 int Spatializer_getRollOff(Handle spat) {
-    auto sp = static_cast<Spatializer*>(spat);
+    TACT_LOOKUP(sp, g_spats, spat, -1);
     auto cv = sp->getRollOff();
     // TODO: make this not bad
     if (cv.name() == "Linear")
@@ -351,69 +763,179 @@ int Spatializer_getRollOff(Handle spat) {
 }
 
 void Spatializer_setWrap(Handle spat, double x, double y) {
-    auto sp = static_cast<Spatializer*>(spat);
+    TACT_LOOKUP(sp, g_spats, spat, );
     sp->setWrap(x,y);
 }
 
 void Spatializer_getWrap(Handle spat, double* x, double* y) {
-    auto sp = static_cast<Spatializer*>(spat);
+    TACT_LOOKUP(sp, g_spats, spat, );
     auto wr = sp->getWrap();
     *x = wr.x;
     *y = wr.y;
 }
 
 bool Spatializer_createGrid(Handle spat, int rows, int cols) {
-    return static_cast<Spatializer*>(spat)->createGrid(rows,cols);
+    TACT_LOOKUP(sp, g_spats, spat, false);
+    return sp->createGrid(rows,cols);
 }
 
 void Spatializer_clear(Handle spat) {
-    static_cast<Spatializer*>(spat)->clear();
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->clear();
 }
 
 void Spatializer_remove(Handle spat, int channel) {
-    static_cast<Spatializer*>(spat)->remove(channel);
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->remove(channel);
 }
 
 int Spatializer_getChannelCount(Handle spat) {
-    return static_cast<Spatializer*>(spat)->getChannelCount();
+    TACT_LOOKUP(sp, g_spats, spat, 0);
+    return sp->getChannelCount();
 }
 
 bool Spatializer_hasChannel(Handle spat, int channel) {
-    return static_cast<Spatializer*>(spat)->hasChannel(channel);
+    TACT_LOOKUP(sp, g_spats, spat, false);
+    return sp->hasChannel(channel);
 }
 
 
 void Spatializer_play(Handle spat, Handle signal) {
-    static_cast<Spatializer*>(spat)->play(g_sigs.at(signal));
+    TACT_LOOKUP(sp, g_spats, spat, );
+    TACT_LOOKUP(sig, g_sigs, signal, );
+    sp->play(*sig);
 }
 
 void Spatializer_stop(Handle spat) {
-    static_cast<Spatializer*>(spat)->stop();
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->stop();
 }
 
 void Spatializer_setVolume(Handle spat, double volume) {
-    static_cast<Spatializer*>(spat)->setVolume(volume);
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->setVolume(volume);
 }
 
 double Spatializer_getVolume(Handle spat) {
-    return static_cast<Spatializer*>(spat)->getVolume();
+    TACT_LOOKUP(sp, g_spats, spat, 0);
+    return sp->getVolume();
 }
 
 void Spatializer_setPitch(Handle spat, double pitch) {
-    static_cast<Spatializer*>(spat)->setPitch(pitch);
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->setPitch(pitch);
 }
 
 double Spatializer_getPitch(Handle spat) {
-    return static_cast<Spatializer*>(spat)->getPitch();
+    TACT_LOOKUP(sp, g_spats, spat, 0);
+    return sp->getPitch();
 }
 
 
 void Spatializer_autoUpdate(Handle spat, bool enable) {
-    static_cast<Spatializer*>(spat)->autoUpdate(enable);
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->autoUpdate(enable);
 }
 
 void Spatializer_update(Handle spat) {
-    static_cast<Spatializer*>(spat)->update();
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->update();
+}
+
+void Spatializer_setMode(Handle spat, int mode) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->setMode(static_cast<Spatializer::Mode>(mode));
+}
+
+int Spatializer_getMode(Handle spat) {
+    TACT_LOOKUP(sp, g_spats, spat, 0);
+    return static_cast<int>(sp->getMode());
+}
+
+void Spatializer_addWaypoint(Handle spat, double time, double x, double y, double z) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->addWaypoint(time, x, y, z);
+}
+
+void Spatializer_setPath(Handle spat, Handle x, Handle y, Handle z) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    TACT_LOOKUP(xSig, g_sigs, x, );
+    TACT_LOOKUP(ySig, g_sigs, y, );
+    TACT_LOOKUP(zSig, g_sigs, z, );
+    sp->setPath(*xSig, *ySig, *zSig);
+}
+
+void Spatializer_setPosition3(Handle spat, int channel, double x, double y, double z) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->setPosition(channel, x, y, z);
+}
+
+void Spatializer_getPosition3(Handle spat, int channel, double* x, double* y, double* z) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    auto p = sp->getPosition(channel);
+    *x = p.x;
+    *y = p.y;
+    *z = p.z;
+}
+
+void Spatializer_setTarget3(Handle spat, double x, double y, double z) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->setTarget(x, y, z);
+}
+
+void Spatializer_getTarget3(Handle spat, double* x, double* y, double* z) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    auto p = sp->getTarget();
+    *x = p.x;
+    *y = p.y;
+    *z = p.z;
+}
+
+int Spatializer_addTarget(Handle spat, double x, double y, double z, Handle signal, double radius, int rollOff, double volume) {
+    TACT_LOOKUP(sp, g_spats, spat, SyntactsError_InvalidHandle);
+    TACT_LOOKUP(sig, g_sigs, signal, SyntactsError_InvalidHandle);
+    return sp->addTarget({x, y, z}, *sig, radius, rollOffCurve(rollOff), volume);
+}
+
+void Spatializer_moveTarget(Handle spat, int id, double x, double y, double z) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->moveTarget(id, {x, y, z});
+}
+
+void Spatializer_setTargetRadius(Handle spat, int id, double r) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->setTargetRadius(id, r);
+}
+
+void Spatializer_setTargetVolume(Handle spat, int id, double volume) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->setTargetVolume(id, volume);
+}
+
+void Spatializer_removeTarget(Handle spat, int id) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->removeTarget(id);
+}
+
+void Spatializer_clearTargets(Handle spat) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    sp->clearTargets();
+}
+
+int Spatializer_getTargets(Handle spat, int* ids, int maxCount) {
+    TACT_LOOKUP(sp, g_spats, spat, 0);
+    auto targets = sp->getTargets();
+    int n = std::min((int)targets.size(), maxCount);
+    std::copy(targets.begin(), targets.begin() + n, ids);
+    return (int)targets.size();
+}
+
+void Spatializer_setPositions(Handle spat, const int* channels, const double* x, const double* y, const double* z, int count) {
+    TACT_LOOKUP(sp, g_spats, spat, );
+    std::vector<Spatializer::Point> positions(count);
+    for (int i = 0; i < count; ++i)
+        positions[i] = {x[i], y[i], z ? z[i] : 0};
+    sp->setPositions(std::vector<int>(channels, channels + count), positions);
 }
 
 
@@ -424,31 +946,37 @@ void Signal_delete(Handle signal) {
 }
 
 bool Signal_valid(Handle signal) {
-    return g_sigs.count(signal) > 0;
+    return g_sigs.valid(signal);
 }
 
 double Signal_sample(Handle signal, double t) {
-    return g_sigs.at(signal).sample(t);
+    TACT_LOOKUP(sig, g_sigs, signal, 0);
+    return sig->sample(t);
 }
 
 double Signal_length(Handle signal) {
-    return g_sigs.at(signal).length();
+    TACT_LOOKUP(sig, g_sigs, signal, 0);
+    return sig->length();
 }
 
 void Signal_setGain(Handle signal, double gain) {
-    g_sigs.at(signal).gain = gain;
+    TACT_LOOKUP(sig, g_sigs, signal, );
+    sig->gain = gain;
 }
 
 double Signal_getGain(Handle signal) {
-    return g_sigs.at(signal).gain;
+    TACT_LOOKUP(sig, g_sigs, signal, 0);
+    return sig->gain;
 }
 
 void Signal_setBias(Handle signal, double bias) {
-    g_sigs.at(signal).bias = bias;
+    TACT_LOOKUP(sig, g_sigs, signal, );
+    sig->bias = bias;
 }
 
 double Signal_getBias(Handle signal) {
-    return g_sigs.at(signal).bias;
+    TACT_LOOKUP(sig, g_sigs, signal, 0);
+    return sig->bias;
 }
 
 
@@ -459,39 +987,50 @@ int Signal_count() {
 ///////////////////////////////////////////////////////////////////////////////
 
 Handle Product_create(Handle lhs, Handle rhs) {
-    return store(Product(g_sigs.at(lhs), g_sigs.at(rhs)));
+    TACT_LOOKUP(lhsSig, g_sigs, lhs, nullptr);
+    TACT_LOOKUP(rhsSig, g_sigs, rhs, nullptr);
+    return store(Product(*lhsSig, *rhsSig));
 }
 
 Handle Sum_create(Handle lhs, Handle rhs) {
-    return store(Sum(g_sigs.at(lhs), g_sigs.at(rhs)));
+    TACT_LOOKUP(lhsSig, g_sigs, lhs, nullptr);
+    TACT_LOOKUP(rhsSig, g_sigs, rhs, nullptr);
+    return store(Sum(*lhsSig, *rhsSig));
 }
 
 Handle Mul_SigFlt(Handle lhs, double rhs) {
-    return store(g_sigs.at(lhs) * rhs);
+    TACT_LOOKUP(lhsSig, g_sigs, lhs, nullptr);
+    return store(*lhsSig * rhs);
 }
 
 Handle Mul_FltSig(double lhs, Handle rhs) {
-    return store(lhs * g_sigs.at(rhs));
+    TACT_LOOKUP(rhsSig, g_sigs, rhs, nullptr);
+    return store(lhs * *rhsSig);
 }
 
 Handle Add_SigFlt(Handle lhs, double rhs) {
-    return store(g_sigs.at(lhs) + rhs);
+    TACT_LOOKUP(lhsSig, g_sigs, lhs, nullptr);
+    return store(*lhsSig + rhs);
 }
 
 Handle Add_FltSig(double lhs, Handle rhs) {
-    return store(lhs + g_sigs.at(rhs));
+    TACT_LOOKUP(rhsSig, g_sigs, rhs, nullptr);
+    return store(lhs + *rhsSig);
 }
 
 Handle Sub_SigFlt(Handle lhs, double rhs) {
-    return store(g_sigs.at(lhs) - rhs);
+    TACT_LOOKUP(lhsSig, g_sigs, lhs, nullptr);
+    return store(*lhsSig - rhs);
 }
 
 Handle Sub_FltSig(double lhs, Handle rhs) {
-    return store(lhs - g_sigs.at(rhs));
+    TACT_LOOKUP(rhsSig, g_sigs, rhs, nullptr);
+    return store(lhs - *rhsSig);
 }
 
 Handle Neg_Sig(Handle signal) {
-    return store(-g_sigs.at(signal));
+    TACT_LOOKUP(sig, g_sigs, signal, nullptr);
+    return store(-*sig);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -501,77 +1040,98 @@ Handle Sequence_create() {
 }
 
 double Sequence_getHead(Handle handle) {
-    Sequence& s = *(Sequence*)g_sigs.at(handle).get();
+    TACT_LOOKUP(seq, g_sigs, handle, 0);
+    Sequence& s = *(Sequence*)seq->get();
     return s.head;
 }
 
 void Sequence_setHead(Handle handle, double head) {
-    Sequence& s = *(Sequence*)g_sigs.at(handle).get();
+    TACT_LOOKUP(seq, g_sigs, handle, );
+    Sequence& s = *(Sequence*)seq->get();
     s.head = head;
 }
 
 void Sequence_pushFlt(Handle handle, double t) {
-    Sequence& s = *(Sequence*)g_sigs.at(handle).get();
+    TACT_LOOKUP(seq, g_sigs, handle, );
+    Sequence& s = *(Sequence*)seq->get();
     s.push(t);
 }
 
 void Sequence_pushSig(Handle handle, Handle signal) {
-    Sequence& s = *(Sequence*)g_sigs.at(handle).get();
-    s.push(g_sigs.at(signal));
+    TACT_LOOKUP(seq, g_sigs, handle, );
+    TACT_LOOKUP(sig, g_sigs, signal, );
+    Sequence& s = *(Sequence*)seq->get();
+    s.push(*sig);
 }
 
 void Sequence_pushSeq(Handle handle, Handle sequence) {
-    Sequence& s1 = *(Sequence*)g_sigs.at(handle).get();
-    Sequence& s2 = *(Sequence*)g_sigs.at(sequence).get();
+    TACT_LOOKUP(seq, g_sigs, handle, );
+    TACT_LOOKUP(other, g_sigs, sequence, );
+    Sequence& s1 = *(Sequence*)seq->get();
+    Sequence& s2 = *(Sequence*)other->get();
     s1.push(s2);
 }
 
 void Sequence_insertSig(Handle handle, Handle signal, double t) {
-    Sequence& s = *(Sequence*)g_sigs.at(handle).get();
-    s.insert(g_sigs.at(signal), t);
+    TACT_LOOKUP(seq, g_sigs, handle, );
+    TACT_LOOKUP(sig, g_sigs, signal, );
+    Sequence& s = *(Sequence*)seq->get();
+    s.insert(*sig, t);
 }
 
 void Sequence_insertSeq(Handle handle, Handle sequence, double t) {
-    Sequence& s1 = *(Sequence*)g_sigs.at(handle).get();
-    Sequence& s2 = *(Sequence*)g_sigs.at(sequence).get();
+    TACT_LOOKUP(seq, g_sigs, handle, );
+    TACT_LOOKUP(other, g_sigs, sequence, );
+    Sequence& s1 = *(Sequence*)seq->get();
+    Sequence& s2 = *(Sequence*)other->get();
     s1.insert(s2, t);
 }
 
 void Sequence_clear(Handle handle) {
-    Sequence& s = *(Sequence*)g_sigs.at(handle).get();
+    TACT_LOOKUP(seq, g_sigs, handle, );
+    Sequence& s = *(Sequence*)seq->get();
     s.clear();
 }
 
 
 
 Handle Sequence_SigSig(Handle lhs, Handle rhs) {
-    auto s = g_sigs.at(lhs) << g_sigs.at(rhs);
+    TACT_LOOKUP(lhsSig, g_sigs, lhs, nullptr);
+    TACT_LOOKUP(rhsSig, g_sigs, rhs, nullptr);
+    auto s = *lhsSig << *rhsSig;
     return store(s);
 }
 
 Handle Sequence_SigFlt(Handle lhs, double rhs) {
-    auto s = g_sigs.at(lhs) << rhs;
+    TACT_LOOKUP(lhsSig, g_sigs, lhs, nullptr);
+    auto s = *lhsSig << rhs;
     return store(s);
 }
 
 Handle Sequence_FltSig(double lhs, Handle rhs) {
-    auto s = lhs << g_sigs.at(rhs);
+    TACT_LOOKUP(rhsSig, g_sigs, rhs, nullptr);
+    auto s = lhs << *rhsSig;
     return store(s);
 }
 
 void Sequence_SeqFlt(Handle lhs, double rhs) {
-    Sequence& s = *(Sequence*)g_sigs.at(lhs).get();
+    TACT_LOOKUP(lhsSig, g_sigs, lhs, );
+    Sequence& s = *(Sequence*)lhsSig->get();
     s << rhs;
 }
 
 void Sequence_SeqSig(Handle lhs, Handle rhs) {
-    Sequence& s = *(Sequence*)g_sigs.at(lhs).get();
-    s << g_sigs.at(rhs);
+    TACT_LOOKUP(lhsSig, g_sigs, lhs, );
+    TACT_LOOKUP(rhsSig, g_sigs, rhs, );
+    Sequence& s = *(Sequence*)lhsSig->get();
+    s << *rhsSig;
 }
 
 void Sequence_SeqSeq(Handle lhs, Handle rhs) {
-    Sequence& s1 = *(Sequence*)g_sigs.at(lhs).get();
-    Sequence& s2 = *(Sequence*)g_sigs.at(rhs).get();
+    TACT_LOOKUP(lhsSig, g_sigs, lhs, );
+    TACT_LOOKUP(rhsSig, g_sigs, rhs, );
+    Sequence& s1 = *(Sequence*)lhsSig->get();
+    Sequence& s2 = *(Sequence*)rhsSig->get();
     s1 << s2;
 }
 
@@ -597,10 +1157,40 @@ Handle Noise_create() {
     return store(Noise());
 }
 
+Handle PinkNoise_create() {
+    return store(PinkNoise());
+}
+
+Handle BrownNoise_create() {
+    return store(BrownNoise());
+}
+
+Handle BandLimitedNoise_create(double bandwidth) {
+    return store(BandLimitedNoise(bandwidth));
+}
+
 Handle Expression_create(const char* expr) {
     return store(Expression(expr));
 }
 
+bool Expression_setVariable(Handle handle, const char* name, double value) {
+    TACT_LOOKUP(sig, g_sigs, handle, false);
+    Expression& e = *(Expression*)sig->get();
+    return e.setVariable(name, value);
+}
+
+double Expression_getVariable(Handle handle, const char* name) {
+    TACT_LOOKUP(sig, g_sigs, handle, 0);
+    Expression& e = *(Expression*)sig->get();
+    return e.getVariable(name);
+}
+
+void Expression_shareVariables(Handle handle, bool share) {
+    TACT_LOOKUP(sig, g_sigs, handle, );
+    Expression& e = *(Expression*)sig->get();
+    e.shareVariables(share);
+}
+
 Handle Samples_create(float* samples, int nSamples, double sampleRate) {
     std::vector<float> vsamples(samples, samples + nSamples);
     return store(Samples(vsamples, sampleRate));
@@ -609,15 +1199,23 @@ Handle Samples_create(float* samples, int nSamples, double sampleRate) {
 ///////////////////////////////////////////////////////////////////////////////
 
 Handle Repeater_create(Handle signal, int repetitions, double delay) {
-    return store(Repeater(g_sigs.at(signal), repetitions, delay));
+    TACT_LOOKUP(sig, g_sigs, signal, nullptr);
+    return store(Repeater(*sig, repetitions, delay));
 }
 
 Handle Stretcher_create(Handle signal, double factor) {
-    return store(Stretcher(g_sigs.at(signal), factor));
+    TACT_LOOKUP(sig, g_sigs, signal, nullptr);
+    return store(Stretcher(*sig, factor));
 }
 
 Handle Reverser_create(Handle signal) {
-    return store(Reverser(g_sigs.at(signal)));
+    TACT_LOOKUP(sig, g_sigs, signal, nullptr);
+    return store(Reverser(*sig));
+}
+
+Handle Filter_create(Handle signal, int type, double frequency, double q, int order) {
+    TACT_LOOKUP(sig, g_sigs, signal, nullptr);
+    return store(Filter(*sig, static_cast<Filter::Type>(type), frequency, q, order));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -639,13 +1237,15 @@ Handle ExponentialDecay_create(double amplitude, double decay) {
 }
 
 Handle SignalEnvelope_create(Handle signal, double duration, double amplitude) {
-    return store(SignalEnvelope(g_sigs.at(signal), duration, amplitude));
+    TACT_LOOKUP(sig, g_sigs, signal, nullptr);
+    return store(SignalEnvelope(*sig, duration, amplitude));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 Handle Sine_create1(Handle x) {
-    return store(Sine(g_sigs.at(x)));
+    TACT_LOOKUP(xSig, g_sigs, x, nullptr);
+    return store(Sine(*xSig));
 }
 
 Handle Sine_create2(double hertz) {
@@ -657,11 +1257,13 @@ Handle Sine_create3(double initial, double rate) {
 }
 
 Handle Sine_create4(double hertz, Handle modulation, double index) {
-    return store(Sine(hertz, g_sigs.at(modulation), index));
+    TACT_LOOKUP(mod, g_sigs, modulation, nullptr);
+    return store(Sine(hertz, *mod, index));
 }
 
 Handle Square_create1(Handle x) {
-    return store(Square(g_sigs.at(x)));
+    TACT_LOOKUP(xSig, g_sigs, x, nullptr);
+    return store(Square(*xSig));
 }
 
 Handle Square_create2(double hertz) {
@@ -673,11 +1275,13 @@ Handle Square_create3(double initial, double rate) {
 }
 
 Handle Square_create4(double hertz, Handle modulation, double index) {
-    return store(Square(hertz, g_sigs.at(modulation), index));
+    TACT_LOOKUP(mod, g_sigs, modulation, nullptr);
+    return store(Square(hertz, *mod, index));
 }
 
 Handle Saw_create1(Handle x) {
-    return store(Saw(g_sigs.at(x)));
+    TACT_LOOKUP(xSig, g_sigs, x, nullptr);
+    return store(Saw(*xSig));
 }
 
 Handle Saw_create2(double hertz) {
@@ -689,11 +1293,13 @@ Handle Saw_create3(double initial, double rate) {
 }
 
 Handle Saw_create4(double hertz, Handle modulation, double index) {
-    return store(Saw(hertz, g_sigs.at(modulation), index));
+    TACT_LOOKUP(mod, g_sigs, modulation, nullptr);
+    return store(Saw(hertz, *mod, index));
 }
 
 Handle Triangle_create1(Handle x) {
-    return store(Triangle(g_sigs.at(x)));
+    TACT_LOOKUP(xSig, g_sigs, x, nullptr);
+    return store(Triangle(*xSig));
 }
 
 Handle Triangle_create2(double hertz) {
@@ -705,7 +1311,8 @@ Handle Triangle_create3(double initial, double rate) {
 }
 
 Handle Triangle_create4(double hertz, Handle modulation, double index) {
-    return store(Triangle(hertz, g_sigs.at(modulation), index));
+    TACT_LOOKUP(mod, g_sigs, modulation, nullptr);
+    return store(Triangle(hertz, *mod, index));
 }
 
 Handle Pwm_create(double frequency, double dutyCycle) {
@@ -715,7 +1322,8 @@ Handle Pwm_create(double frequency, double dutyCycle) {
 ///////////////////////////////////////////////////////////////////////////////
 
 bool Library_saveSignal(Handle signal, const char* name) {
-    return Library::saveSignal(g_sigs.at(signal), name);
+    TACT_LOOKUP(sig, g_sigs, signal, false);
+    return Library::saveSignal(*sig, name);
 } 
 
 Handle Library_loadSignal(const char* name) {
@@ -729,8 +1337,23 @@ bool Library_deleteSignal(const char* name) {
     return Library::deleteSignal(name);
 }
 
+bool Library_saveSpatializer(Handle spat, const char* name) {
+    TACT_LOOKUP(sp, g_spats, spat, false);
+    return Library::saveSpatializer(*sp, name);
+}
+
+bool Library_loadSpatializer(Handle spat, const char* name) {
+    TACT_LOOKUP(sp, g_spats, spat, false);
+    return Library::loadSpatializer(*sp, name);
+}
+
+bool Library_deleteSpatializer(const char* name) {
+    return Library::deleteSpatializer(name);
+}
+
 bool Library_exportSignal(Handle signal, const char* filePath, int format, int sampleRate, double maxLength) {
-    return Library::exportSignal(g_sigs.at(signal), filePath, static_cast<FileFormat>(format), sampleRate, maxLength);
+    TACT_LOOKUP(sig, g_sigs, signal, false);
+    return Library::exportSignal(*sig, filePath, static_cast<FileFormat>(format), sampleRate, maxLength);
 }
 
 Handle Library_importSignal(const char* filePath, int format, int sampleRate) {
@@ -740,6 +1363,33 @@ Handle Library_importSignal(const char* filePath, int format, int sampleRate) {
     return nullptr;
 }
 
+void Library_prefetchSignal(const char* name) {
+    // keep futures alive so prefetching doesn't block the caller
+    static std::mutex mutex;
+    static std::vector<std::future<bool>> pending;
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.erase(std::remove_if(pending.begin(), pending.end(), [](std::future<bool>& f) {
+        return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }), pending.end());
+    pending.push_back(Library::prefetchSignal(name));
+}
+
+void Library_setCacheCapacity(long long bytes) {
+    Library::setCacheCapacity(static_cast<std::size_t>(std::max(bytes, 0ll)));
+}
+
+void Library_clearCache() {
+    Library::clearCache();
+}
+
+long long Library_cacheHits() {
+    return static_cast<long long>(Library::getCacheStats().hits);
+}
+
+long long Library_cacheMisses() {
+    return static_cast<long long>(Library::getCacheStats().misses);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 int Debug_sigMapSize() {
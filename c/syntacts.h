@@ -15,7 +15,10 @@
 extern "C" {
 #endif
 
+/// Opaque object id (slot index and generation), 0 is never valid. Functions given an invalid or
+/// deleted Handle return SyntactsError_InvalidHandle, false, 0, or a null Handle and do nothing.
 typedef void* Handle;
+typedef long long Voice; ///< encoded VoiceId (channel << 32 | id), negative if play failed
 
 ///////////////////////////////////////////////////////////////////////////////
 // SYNTACTS CONFIG
@@ -39,10 +42,21 @@ EXPORT int Session_open2(Handle session, int index);
 EXPORT int Session_open3(Handle session, int index, int channelCount, double sampleRate);
 EXPORT int Session_open4(Handle session, int api);
 EXPORT int Session_open5(Handle session, char* name, int api);
+EXPORT int Session_open6(Handle session, int index, int channelCount, double sampleRate, int framesPerBuffer, double latency);
+EXPORT int Session_openJack(Handle session, int channelCount, char* clientName, bool connect);
+EXPORT int Session_openOffline(Handle session, int channelCount, double sampleRate);
+EXPORT int Session_render(Handle session, float* buffer, int frames);
 EXPORT int Session_close(Handle session);
 EXPORT bool Session_isOpen(Handle session);
 
 EXPORT int Session_play(Handle session, int channel, Handle signal);
+EXPORT int Session_play2(Handle session, int channel, Handle signal, int priority);
+EXPORT Voice Session_playVoice(Handle session, int channel, Handle signal, int priority);
+EXPORT int Session_stopVoice(Handle session, Voice voice);
+EXPORT int Session_setVoiceVolume(Handle session, Voice voice, double volume);
+EXPORT int Session_setVoicePitch(Handle session, Voice voice, double pitch);
+EXPORT bool Session_isVoicePlaying(Handle session, Voice voice);
+EXPORT double Session_getVoiceTime(Handle session, Voice voice);
 EXPORT int Session_playAll(Handle session, Handle signal);
 EXPORT int Session_stop(Handle session, int channel);
 EXPORT int Session_stopAll(Handle session);
@@ -54,13 +68,30 @@ EXPORT bool Session_isPlaying(Handle session, int channel);
 EXPORT bool Session_isPaused(Handle session, int channel);
 
 EXPORT int Session_setVolume(Handle session, int channel, double volume);
+EXPORT int Session_setVolumes(Handle session, const int* channels, const double* volumes, int count);
 EXPORT double Session_getVolume(Handle session, int channel);
 EXPORT int Session_setPitch(Handle session, int channel, double pitch);
 EXPORT double Session_getPitch(Handle session, int channel);
 EXPORT double Session_getLevel(Handle session, int channel);
+EXPORT int Session_setMaxVoices(Handle session, int voices);
+EXPORT int Session_getMaxVoices(Handle session);
+EXPORT int Session_getVoiceCount(Handle session, int channel);
+EXPORT void Session_setVoiceStealing(Handle session, int policy);
+EXPORT int Session_getVoiceStealing(Handle session);
+EXPORT int Session_setOutputStage(Handle session, int channel, bool dcBlocker, double dcCutoff, bool eq, double eqFrequency, double eqGain, double eqQ, bool limiter, double threshold, double lookAhead, double release, bool softClip);
+EXPORT int Session_setFadeTime(Handle session, double seconds);
+EXPORT double Session_getFadeTime(Handle session);
 EXPORT int Session_getChannelCount(Handle session);
 EXPORT double Session_getSampleRate(Handle session);
 EXPORT double Session_getCpuLoad(Handle session);
+EXPORT double Session_getLatency(Handle session);
+EXPORT double Session_getTime(Handle session);
+EXPORT void Session_getCallbackStats(Handle session, int channel, double* mean, double* max, long long* counts);
+EXPORT int Session_getQueueDepth(Handle session);
+EXPORT int Session_getQueueDepthMax(Handle session);
+EXPORT long long Session_getXrunCount(Handle session);
+EXPORT int Session_getXrunTimes(Handle session, double* times, int maxCount);
+EXPORT void Session_resetStats(Handle session);
 
 EXPORT int Session_getCurrentDevice(Handle session);
 EXPORT int Session_getDefaultDevice(Handle session);
@@ -121,6 +152,24 @@ EXPORT double Spatializer_getPitch(Handle spat);
 EXPORT void Spatializer_autoUpdate(Handle spat, bool enable);
 EXPORT void Spatializer_update(Handle spat);
 
+EXPORT void Spatializer_setMode(Handle spat, int mode);
+EXPORT int Spatializer_getMode(Handle spat);
+EXPORT void Spatializer_addWaypoint(Handle spat, double time, double x, double y, double z);
+EXPORT void Spatializer_setPath(Handle spat, Handle x, Handle y, Handle z);
+
+EXPORT void Spatializer_setPosition3(Handle spat, int channel, double x, double y, double z);
+EXPORT void Spatializer_getPosition3(Handle spat, int channel, double* x, double* y, double* z);
+EXPORT void Spatializer_setTarget3(Handle spat, double x, double y, double z);
+EXPORT void Spatializer_getTarget3(Handle spat, double* x, double* y, double* z);
+EXPORT int Spatializer_addTarget(Handle spat, double x, double y, double z, Handle signal, double radius, int rollOff, double volume);
+EXPORT void Spatializer_moveTarget(Handle spat, int id, double x, double y, double z);
+EXPORT void Spatializer_setTargetRadius(Handle spat, int id, double r);
+EXPORT void Spatializer_setTargetVolume(Handle spat, int id, double volume);
+EXPORT void Spatializer_removeTarget(Handle spat, int id);
+EXPORT void Spatializer_clearTargets(Handle spat);
+EXPORT int Spatializer_getTargets(Handle spat, int* ids, int maxCount);
+EXPORT void Spatializer_setPositions(Handle spat, const int* channels, const double* x, const double* y, const double* z, int count);
+
 // TODO: getRollOff, getChannels
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -185,7 +234,13 @@ EXPORT Handle Scalar_create(double value);
 EXPORT Handle Ramp_create1(double initial, double rate);
 EXPORT Handle Ramp_create2(double initial, double final, double duration);
 EXPORT Handle Noise_create();
+EXPORT Handle PinkNoise_create();
+EXPORT Handle BrownNoise_create();
+EXPORT Handle BandLimitedNoise_create(double bandwidth);
 EXPORT Handle Expression_create(const char* expr);
+EXPORT bool Expression_setVariable(Handle handle, const char* name, double value);
+EXPORT double Expression_getVariable(Handle handle, const char* name);
+EXPORT void Expression_shareVariables(Handle handle, bool share);
 EXPORT Handle Samples_create(float* samples, int nSamples, double sampleRate);
 
 // TODO: PolyBezier
@@ -197,6 +252,7 @@ EXPORT Handle Samples_create(float* samples, int nSamples, double sampleRate);
 EXPORT Handle Repeater_create(Handle signal, int repetitions, double delay);
 EXPORT Handle Stretcher_create(Handle signal, double factor);
 EXPORT Handle Reverser_create(Handle signal);
+EXPORT Handle Filter_create(Handle signal, int type, double frequency, double q, int order);
 
 ///////////////////////////////////////////////////////////////////////////////
 // ENVELOPE
@@ -243,8 +299,16 @@ EXPORT Handle Pwm_create(double frequency, double dutyCycle);
 EXPORT bool Library_saveSignal(Handle signal, const char* name);
 EXPORT Handle Library_loadSignal(const char* name);
 EXPORT bool Library_deleteSignal(const char* name);
+EXPORT bool Library_saveSpatializer(Handle spat, const char* name);
+EXPORT bool Library_loadSpatializer(Handle spat, const char* name);
+EXPORT bool Library_deleteSpatializer(const char* name);
 EXPORT bool Library_exportSignal(Handle signal, const char* filePath, int format, int sampleRate, double maxLength);
 EXPORT Handle Library_importSignal(const char* filePath, int format, int sampleRate);
+EXPORT void Library_prefetchSignal(const char* name);
+EXPORT void Library_setCacheCapacity(long long bytes);
+EXPORT void Library_clearCache();
+EXPORT long long Library_cacheHits();
+EXPORT long long Library_cacheMisses();
 
 ///////////////////////////////////////////////////////////////////////////////
 // DEBUG
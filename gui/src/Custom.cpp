@@ -84,7 +84,38 @@ void RenderGrid(ImRect bb, int nx, int ny, ImU32 gridColor, ImU32 bgColor, float
     }
 }
 
-void PlotSignal(const char *label, const tact::Signal &sig, std::vector<ImVec2> &points, float t1, float t2, ImVec4 color, float thickness, ImVec2 size, bool grid, bool text)
+namespace {
+
+WaveformCache& Waveforms() {
+    static WaveformCache cache;
+    return cache;
+}
+
+/// Counts the frames in which Signals may have been edited. Signals only change in response to input,
+/// so the count advances on frames with input (and the frame after, when drops and clicks take effect).
+std::uint64_t EditRevision() {
+    static std::uint64_t revision = 0;
+    static int  frame    = -1;
+    static bool hadInput = true;
+    ImGuiContext& g = *GImGui;
+    if (g.FrameCount != frame) {
+        frame = g.FrameCount;
+        const ImGuiIO& io = g.IO;
+        bool input = IsAnyMouseDown() || io.MouseWheel != 0 || io.MouseWheelH != 0 || io.InputQueueCharacters.Size > 0 || g.DragDropActive;
+        for (int i = 0; i < IM_ARRAYSIZE(io.MouseReleased) && !input; ++i)
+            input = io.MouseReleased[i];
+        for (int i = 0; i < IM_ARRAYSIZE(io.KeysDown) && !input; ++i)
+            input = io.KeysDown[i];
+        if (input || hadInput)
+            ++revision;
+        hadInput = input;
+    }
+    return revision;
+}
+
+} // namespace
+
+void PlotSignal(const char *label, const tact::Signal &sig, std::vector<ImVec2> &points, float t1, float t2, ImVec4 color, float thickness, ImVec2 size, bool grid, bool text, bool cache)
 {
     ImGuiWindow *window = GetCurrentWindow();
     if (window->SkipItems)
@@ -104,29 +135,36 @@ void PlotSignal(const char *label, const tact::Signal &sig, std::vector<ImVec2>
         RenderGrid(frame_bb, 10, 8, GetColorU32(ImGuiCol_WindowBg), GetColorU32(ImGuiCol_FrameBg), 1.0f, style.FrameRounding);
     else
         RenderFrame(frame_bb.Min, frame_bb.Max, GetColorU32(ImGuiCol_FrameBg), true, style.FrameRounding);
-    const ImVec2 start = {frame_bb.Min.x, frame_bb.GetCenter().y};
-    const float dx = frame_bb.GetWidth() / points.size();
-    const float ys = -frame_bb.GetHeight() * 0.5f * 0.95f;
 
-    float dt = (t2 - t1) / points.size();
-    float t = t1;
-    float x = start.x;
-    for (int i = 0; i < points.size(); ++i)
-    {
-        float s = ImClamp((float)sig.sample(t), -1.0f, 1.0f);
-        float y = start.y + s * ys;
-        points[i].x = x;
-        points[i].y = y;
-        t += dt;
-        x += dx;
-    }
-    
-    // DrawList->Flags &= ~ImDrawListFlags_AntiAliasedLines;
-    // DrawList->AddPolyline(&points[0], (int)points.size(), ImGui::ColorConvertFloat4ToU32(color), false, thickness);
     auto col32 = ImGui::ColorConvertFloat4ToU32(color);
-    for (int i = 0; i < points.size()-1; ++i)
-        DrawList->AddLine(points[i], points[i+1], col32, thickness);
-    // DrawList->Flags |= ImDrawListFlags_AntiAliasedLines;
+    auto waveform = cache ? Waveforms().get(sig, t2, id, EditRevision()) : nullptr;
+    if (waveform) {
+        RenderWaveform(DrawList, *waveform, t1, t2, frame_bb, col32, thickness);
+    }
+    else {
+        const ImVec2 start = {frame_bb.Min.x, frame_bb.GetCenter().y};
+        const float dx = frame_bb.GetWidth() / points.size();
+        const float ys = -frame_bb.GetHeight() * 0.5f * 0.95f;
+
+        float dt = (t2 - t1) / points.size();
+        float t = t1;
+        float x = start.x;
+        for (int i = 0; i < points.size(); ++i)
+        {
+            float s = ImClamp((float)sig.sample(t), -1.0f, 1.0f);
+            float y = start.y + s * ys;
+            points[i].x = x;
+            points[i].y = y;
+            t += dt;
+            x += dx;
+        }
+        
+        // DrawList->Flags &= ~ImDrawListFlags_AntiAliasedLines;
+        // DrawList->AddPolyline(&points[0], (int)points.size(), ImGui::ColorConvertFloat4ToU32(color), false, thickness);
+        for (int i = 0; i < points.size()-1; ++i)
+            DrawList->AddLine(points[i], points[i+1], col32, thickness);
+        // DrawList->Flags |= ImDrawListFlags_AntiAliasedLines;
+    }
 
     if (text) {
         std::string txt;
@@ -141,6 +179,12 @@ void PlotSignal(const char *label, const tact::Signal &sig, std::vector<ImVec2>
 }
 
 void RenderSignalInBounds(ImDrawList* DrawList, const tact::Signal& sig, float t1, float t2, ImRect bb, ImVec4 color, float thickness, int n) {
+    if (auto waveform = Waveforms().get(sig, t2, GetID(&sig), EditRevision())) {
+        DrawList->PushClipRect(bb.Min, bb.Max, true);
+        RenderWaveform(DrawList, *waveform, t1, t2, bb, ImGui::ColorConvertFloat4ToU32(color), thickness);
+        DrawList->PopClipRect();
+        return;
+    }
     static std::vector<ImVec2> buffer;
     if (n == 0)
         n = (int)bb.GetWidth() * 2;
@@ -171,6 +215,32 @@ void RenderSignalInBounds(ImDrawList* DrawList, const tact::Signal& sig, float t
     DrawList->PopClipRect();
 }
 
+void RenderWaveform(ImDrawList* DrawList, const Waveform& waveform, float t1, float t2, ImRect bb, ImU32 color, float thickness) {
+    static std::vector<float> mins, maxs;
+    if (bb.GetWidth() <= 0)
+        return;
+    // only compute the pixel columns which are visible (Sequencer tracks may extend far off screen)
+    const float xa = bb.Min.x + ImMax(0.0f, std::floor(DrawList->GetClipRectMin().x - bb.Min.x));
+    const float xb = ImMin(bb.Max.x, DrawList->GetClipRectMax().x);
+    const int n = (int)std::ceil(xb - xa);
+    if (n <= 0)
+        return;
+    const float dt = (t2 - t1) / bb.GetWidth();
+    mins.resize(n);
+    maxs.resize(n);
+    waveform.envelope(t1 + (xa - bb.Min.x) * dt, t1 + (xa - bb.Min.x + n) * dt, n, mins.data(), maxs.data());
+    const float y0 = bb.GetCenter().y;
+    const float ys = -bb.GetHeight() * 0.5f * 0.95f;
+    for (int i = 0; i < n; ++i)
+    {
+        // extend each column to touch the previous one so the trace stays connected
+        float lo = ImClamp(i > 0 ? ImMin(mins[i], maxs[i-1]) : mins[i], -1.0f, 1.0f);
+        float hi = ImClamp(i > 0 ? ImMax(maxs[i], mins[i-1]) : maxs[i], -1.0f, 1.0f);
+        float x = xa + i;
+        DrawList->AddRectFilled(ImVec2(x, y0 + hi * ys - 0.5f * thickness), ImVec2(x + 1, y0 + lo * ys + 0.5f * thickness), color);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 bool TimelineScrollbar(float* ltime, float* rtime, bool* lGrabbed, bool* rGrabbed, bool* cGrabbed, ImVec2 size, float grabWidth) {
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <syntacts>
+#include "Waveform.hpp"
 
 namespace ImGui {
 
@@ -13,8 +14,12 @@ namespace ImGui {
 // bool MiniSliderFloat(const char* label, float* v, float v_min, float v_max, bool top = true, float power = 1.0f);
 
 void RenderGrid(ImRect bb, int nx, int ny, ImU32 gridColor, ImU32 bgColor, float thickness = 1.0f, float rounding = 0);
-void PlotSignal(const char* label,  const tact::Signal& sig, std::vector<ImVec2>& points, float t1, float t2, ImVec4 color, float thickness, ImVec2 size = ImVec2(-1,0), bool grid = true, bool text = true);
+/// Plots a Signal from its cached Waveform (if cache), falling back to sampling it at points.size() points while the Waveform is built.
+void PlotSignal(const char* label,  const tact::Signal& sig, std::vector<ImVec2>& points, float t1, float t2, ImVec4 color, float thickness, ImVec2 size = ImVec2(-1,0), bool grid = true, bool text = true, bool cache = true);
+/// Renders a Signal from its cached Waveform (identified by the address of sig), falling back to sampling it at n points while the Waveform is built.
 void RenderSignalInBounds(ImDrawList* DrawList, const tact::Signal& sig, float t1, float t2, ImRect bb, ImVec4 color, float thickness, int n = 0);
+/// Renders the min/max envelope of a Waveform with one column per pixel.
+void RenderWaveform(ImDrawList* DrawList, const Waveform& waveform, float t1, float t2, ImRect bb, ImU32 color, float thickness);
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -24,6 +24,11 @@ Library::Library(Gui& gui) : Widget(gui),
     gui.on_file_drop.connect(this, &Library::onFileDrop);
 }
 
+Library::~Library() {
+    // stop before members the callback touches are destroyed
+    m_watcher.stop();
+}
+
 tact::Signal Library::getSelectedSignal()
 {
     if (m_lib.count(m_selected))
@@ -59,7 +64,7 @@ void Library::onFileDrop(const std::vector<std::string>& paths) {
 }
 
 // function called when disk files change
-void Library::onFileChange(std::string path, FileStatus status) {
+void Library::onFileChange(const std::string& path, tact::FileStatus status) {
     std::lock_guard<std::mutex> lock(m_mtx);
     if (m_ignoreFilChange) {
         m_ignoreFilChange = false;
@@ -68,7 +73,7 @@ void Library::onFileChange(std::string path, FileStatus status) {
     fs::path p(path);
     if (p.extension() == ".sig") {
         std::string name = p.stem().string();
-        if (status == FileStatus::Created) {
+        if (status == tact::FileStatus::Created) {
             if (m_lib.count(name) == 0)
             {
                 m_lib[name] = Entry();
@@ -77,11 +82,11 @@ void Library::onFileChange(std::string path, FileStatus status) {
                 gui.status.pushMessage("Signal " + name + " added from disk");
             }
         }
-        else if (status == FileStatus::Erased)  {
+        else if (status == tact::FileStatus::Erased)  {
             m_lib.erase(name);
             gui.status.pushMessage("Signal " + name + " deleted from disk");
         }
-        else if (status == FileStatus::Modified) {
+        else if (status == tact::FileStatus::Modified) {
             if (m_lib.count(name)) {
                 m_lib[name].loaded = false;
                 gui.status.pushMessage("Signal " + name + " modified on disk");
@@ -111,11 +116,15 @@ void Library::init()
     // set selected entry
     if (m_lib.size() > 0)
         m_selected = m_lib.begin()->first;
+    // warm the Signal cache so hovering/dragging items doesn't hit the disk
+    std::vector<std::string> names;
+    names.reserve(m_lib.size());
+    for (auto& pair : m_lib)
+        names.push_back(pair.first);
+    m_prefetch = tact::Library::prefetchSignals(names);
  
-    /// start FileWatcher
-    auto tf = [&]() { m_watcher.start(memberBind(this,&Library::onFileChange)); };
-    std::thread t(tf);
-    t.detach();
+    /// start FileWatcher (runs on its own thread)
+    m_watcher.start(memberBind(this,&Library::onFileChange));
 }
 
 void Library::update()
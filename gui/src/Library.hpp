@@ -6,13 +6,13 @@
 #include <set>
 #include "Palette.hpp"
 #include "Visualizer.hpp"
-#include "FileWatcher.hpp"
 
 
 class Library : public Widget {
 public:
 
     Library(Gui& gui);
+    ~Library();
 
     struct Entry {
         std::string name;
@@ -29,18 +29,19 @@ private:
     tact::Signal getSelectedSignal();
 private:
 
-    void onFileChange(std::string path, FileStatus status);
+    void onFileChange(const std::string& path, tact::FileStatus status);
     void onFileDrop(const std::vector<std::string>& paths);
 
 public:
     Palette palette;
 private:
     std::mutex m_mtx;
-    FileWatcher m_watcher;
+    tact::FileWatcher m_watcher;
     std::string m_selected;
     int m_selection = -1;
     char m_inputBuffer[64] = "";
     std::map<std::string, Entry> m_lib;
+    std::future<bool> m_prefetch;
     bool m_ignoreFilChange = false;
     bool m_focused;
 };
\ No newline at end of file
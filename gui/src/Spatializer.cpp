@@ -118,7 +118,7 @@ void Spatializer::update()
         ImGui::DragFloat("Position", &m_target.pos.x, 0.005f, 0.0f, 1.0f);
     ImGui::DragFloat("Radius", &m_target.radius, 0.005f, 0.0f, 1.0f);
     static std::vector<ImVec2> points(100);
-    ImGui::PlotSignal("##Empty", CurveSignal(g_curveMap[m_rollOffHoveredIdx == -1 ? m_rollOffIndex : m_rollOffHoveredIdx].second), points, 0, 2, Greens::Chartreuse, 1, ImVec2(control_width,45), false, false);     
+    ImGui::PlotSignal("##Empty", CurveSignal(g_curveMap[m_rollOffHoveredIdx == -1 ? m_rollOffIndex : m_rollOffHoveredIdx].second), points, 0, 2, Greens::Chartreuse, 1, ImVec2(control_width,45), false, false, false);     
     m_rollOffHoveredIdx = -1;
     ImGui::SameLine();
     ImGui::Text("Roll-Off");
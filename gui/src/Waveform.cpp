@@ -0,0 +1,191 @@
+#include "Waveform.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/memory.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include <cereal/types/functional.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/utility.hpp>
+
+namespace {
+
+constexpr double      MAX_SAMPLE_RATE = 48000;   // base resolution of short Signals
+constexpr std::size_t MAX_SAMPLES     = 1 << 20; // long Signals are sampled more coarsely
+constexpr int         BLOCK           = 1024;
+
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+Waveform::Waveform(const tact::Signal& signal, double duration, double sampleRate) :
+    m_duration(duration),
+    m_sampleRate(sampleRate)
+{
+    std::size_t n = std::max<std::size_t>(1, (std::size_t)std::ceil(duration * sampleRate));
+    m_samples.resize(n);
+    tact::Signal::Context ctx;
+    signal.prepare(ctx);
+    double t[BLOCK], b[BLOCK];
+    for (std::size_t i = 0; i < n; i += BLOCK) {
+        int m = (int)std::min<std::size_t>(BLOCK, n - i);
+        for (int j = 0; j < m; ++j)
+            t[j] = (i + j) / sampleRate;
+        signal.process(&ctx, t, b, m);
+        for (int j = 0; j < m; ++j)
+            m_samples[i + j] = (float)b[j];
+    }
+    // each level halves the previous one until a single bucket summarizes the whole Signal
+    const float* lo = m_samples.data();
+    const float* hi = m_samples.data();
+    std::size_t size = n;
+    while (size > 1) {
+        std::size_t next = (size + 1) / 2;
+        std::vector<float> mn(next), mx(next);
+        for (std::size_t i = 0; i < size / 2; ++i) {
+            mn[i] = std::min(lo[2 * i], lo[2 * i + 1]);
+            mx[i] = std::max(hi[2 * i], hi[2 * i + 1]);
+        }
+        if (size & 1) {
+            mn[next - 1] = lo[size - 1];
+            mx[next - 1] = hi[size - 1];
+        }
+        m_min.push_back(std::move(mn));
+        m_max.push_back(std::move(mx));
+        lo = m_min.back().data();
+        hi = m_max.back().data();
+        size = next;
+    }
+}
+
+void Waveform::envelope(double t1, double t2, int n, float* min, float* max) const {
+    if (n <= 0)
+        return;
+    const std::int64_t N = (std::int64_t)m_samples.size();
+    const double s1  = t1 * m_sampleRate;
+    const double spp = (t2 - t1) * m_sampleRate / n; // samples per column
+    if (spp < 1) {
+        // zoomed in past the samples, so interpolate them
+        auto at = [&](std::int64_t i) { return i < 0 || i >= N ? 0.0f : m_samples[i]; };
+        for (int c = 0; c < n; ++c) {
+            double s = s1 + (c + 0.5) * spp;
+            std::int64_t i = (std::int64_t)std::floor(s);
+            float f = (float)(s - i);
+            float a = at(i), b = at(i + 1);
+            min[c] = max[c] = a + (b - a) * f;
+        }
+        return;
+    }
+    // use the level whose buckets are no wider than a column, and snap column edges to its buckets
+    // so every sample falls in exactly one column and no peak is missed
+    int k = std::min((int)std::log2(spp), (int)m_min.size());
+    const float* lo = k == 0 ? m_samples.data() : m_min[k - 1].data();
+    const float* hi = k == 0 ? m_samples.data() : m_max[k - 1].data();
+    const std::int64_t size = k == 0 ? N : (std::int64_t)m_min[k - 1].size();
+    const double bucket = std::ldexp(1.0, k);
+    std::int64_t b0 = std::llround(s1 / bucket);
+    for (int c = 0; c < n; ++c) {
+        std::int64_t b1 = std::max(b0 + 1, (std::int64_t)std::llround((s1 + (c + 1) * spp) / bucket));
+        bool outside = b0 < 0 || b1 > size;
+        float mn = outside ? 0 :  std::numeric_limits<float>::infinity();
+        float mx = outside ? 0 : -std::numeric_limits<float>::infinity();
+        for (std::int64_t b = std::max<std::int64_t>(b0, 0); b < std::min(b1, size); ++b) {
+            mn = std::min(mn, lo[b]);
+            mx = std::max(mx, hi[b]);
+        }
+        min[c] = mn;
+        max[c] = mx;
+        b0 = b1;
+    }
+}
+
+double Waveform::duration() const {
+    return m_duration;
+}
+
+std::size_t Waveform::bytes() const {
+    std::size_t count = m_samples.size();
+    for (auto& level : m_min)
+        count += 2 * level.size();
+    return count * sizeof(float);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+WaveformCache::WaveformCache(std::size_t capacity) :
+    m_capacity(capacity),
+    m_bytes(0),
+    m_buildKey(0),
+    m_failedKey(0)
+{ }
+
+std::shared_ptr<const Waveform> WaveformCache::get(const tact::Signal& signal, double duration, std::size_t id, std::uint64_t revision) {
+    collect();
+    // infinite Signals are summarized over a power of two so scrolling doesn't rebuild every frame
+    double length = signal.length();
+    duration = length != tact::INF ? length : std::exp2(std::ceil(std::log2(std::max(duration, 1.0))));
+    std::size_t k = key(signal, duration, id, revision);
+    if (k == 0 || k == m_failedKey)
+        return nullptr;
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->key == k) {
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            return it->waveform;
+        }
+    }
+    // build one Waveform at a time; edits made meanwhile are picked up once it finishes
+    if (!m_build.valid()) {
+        double sampleRate = std::min(MAX_SAMPLE_RATE, MAX_SAMPLES / std::max(duration, 1e-9));
+        m_buildKey = k;
+        m_build = std::async(std::launch::async, [signal, duration, sampleRate]() {
+            return std::make_shared<const Waveform>(signal, duration, sampleRate);
+        });
+    }
+    return nullptr;
+}
+
+std::size_t WaveformCache::key(const tact::Signal& signal, double duration, std::size_t id, std::uint64_t revision) {
+    auto it = m_slots.find(id);
+    if (it != m_slots.end() && it->second.revision == revision && it->second.duration == duration)
+        return it->second.key;
+    // Signals are rebuilt every frame, so they're identified by their serialized content (0 if it can't be)
+    std::size_t k = 0;
+    try {
+        std::ostringstream ss;
+        {
+            cereal::BinaryOutputArchive archive(ss);
+            archive(signal, duration);
+        }
+        k = std::max<std::size_t>(1, std::hash<std::string>()(ss.str()));
+    }
+    catch (...) { }
+    // plots come and go with tracks and nodes, so forget them all now and then
+    if (m_slots.size() >= 1024)
+        m_slots.clear();
+    m_slots[id] = {revision, duration, k};
+    return k;
+}
+
+void WaveformCache::collect() {
+    if (!m_build.valid() || m_build.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+    std::shared_ptr<const Waveform> waveform;
+    try {
+        waveform = m_build.get();
+    }
+    catch (...) {
+        // e.g. bad_alloc for a huge Signal; drop the build and fall back to sampling that Signal
+        m_failedKey = m_buildKey;
+        return;
+    }
+    m_bytes += waveform->bytes();
+    m_entries.push_front({m_buildKey, std::move(waveform)});
+    while (m_bytes > m_capacity && m_entries.size() > 1) {
+        m_bytes -= m_entries.back().waveform->bytes();
+        m_entries.pop_back();
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <syntacts>
+#include <future>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/// A min/max pyramid of a Signal sampled over [0, duration]. Level k summarizes 2^k samples, so
+/// the envelope of any time range can be drawn in O(pixels) without missing peaks between samples.
+class Waveform {
+public:
+    /// Samples the Signal and builds the pyramid (expensive, call off the GUI thread).
+    Waveform(const tact::Signal& signal, double duration, double sampleRate);
+    /// Computes the min and max of n equal columns spanning [t1, t2]. Times outside of the Waveform are 0.
+    void envelope(double t1, double t2, int n, float* min, float* max) const;
+    /// Returns the duration the Waveform covers.
+    double duration() const;
+    /// Returns the memory used by the Waveform in bytes.
+    std::size_t bytes() const;
+private:
+    double m_duration;
+    double m_sampleRate;
+    std::vector<std::vector<float>> m_min; ///< level k > 0 is m_min[k-1]
+    std::vector<std::vector<float>> m_max; ///< level k > 0 is m_max[k-1]
+    std::vector<float> m_samples;          ///< level 0
+};
+
+/// Builds Waveforms on a background thread and caches them by Signal content, so rebuilding an
+/// identical Signal every frame hits the cache and any edit to it invalidates it. GUI thread only.
+class WaveformCache {
+public:
+    WaveformCache(std::size_t capacity = 64 * 1024 * 1024);
+    /// Returns the Waveform of a Signal covering at least [0, duration], or nullptr while it is being built.
+    /// id identifies the plot drawing the Signal and revision counts edits made in the GUI. The Signal's 
+    /// content is only hashed again when either changes, so frames without edits don't serialize it.
+    std::shared_ptr<const Waveform> get(const tact::Signal& signal, double duration, std::size_t id, std::uint64_t revision);
+private:
+    struct Entry {
+        std::size_t key;
+        std::shared_ptr<const Waveform> waveform;
+    };
+    struct Slot {
+        std::uint64_t revision;
+        double duration;
+        std::size_t key;
+    };
+    std::size_t key(const tact::Signal& signal, double duration, std::size_t id, std::uint64_t revision);
+    void collect();
+private:
+    std::size_t m_capacity;
+    std::size_t m_bytes;
+    std::list<Entry> m_entries; ///< most recently used first
+    std::unordered_map<std::size_t, Slot> m_slots; ///< content key last computed for each plot id
+    std::size_t m_buildKey;
+    std::size_t m_failedKey; ///< key of the last Waveform that failed to build, so it isn't retried every frame
+    std::future<std::shared_ptr<const Waveform>> m_build;
+};
@@ -29,9 +29,18 @@
 #define SYNTACTS_VERSION_MINOR 3
 #define SYNTACTS_VERSION_PATCH 0
 
-/// The maximum number of signals that can be played in unison (polyphony) on a single channel
+/// The default number of signals that can be played in unison (polyphony) on a single channel
+/// (can be changed per Session with Session::setMaxVoices)
 #define SYNTACTS_MAX_VOICES 8
 
+/// The default length in seconds of the ramps that fade voices in and out when they start, stop,
+/// or are stolen, which prevents clicks (can be changed per Session with Session::setFadeTime)
+#define SYNTACTS_FADE_TIME 0.002
+
+/// The number of samples composite Signals process at a time when sampled in blocks
+/// (i.e. the size of their temporary stack buffers)
+#define SYNTACTS_BLOCK_SIZE 64
+
 /// If uncommented, Signals will use a fixed size memory pool for allocation.
 /// At this time, there doesn't seem to a great deal of benifit from doing this,
 /// but one day it may be be possible to reap the benifits of 
@@ -52,6 +61,10 @@
 /// effectively breaks the GUI as it is currently implemented, so be warned!
 // #define SYNTACTS_USE_SHARED_PTR 
 
+/// If uncommented, Signals will verify that their cached length matches a freshly computed
+/// length every time length() is called (debug aid for code that mutates Signals without get())
+// #define SYNTACTS_VERIFY_LENGTH_CACHE
+
 #ifndef SYNTACTS_STATIC
     #ifdef SYNTACTS_EXPORTS
         #define SYNTACTS_API __declspec(dllexport)
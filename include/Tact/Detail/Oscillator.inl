@@ -10,18 +10,42 @@ inline double Sine::sample(double t) const {
     return std::sin(x.sample(t));
 }
 
+inline void Sine::process(Signal::Context* ctx, const double* t, double* b, int n) const {
+    x.process(ctx, t, b, n);
+    for (int i = 0; i < n; ++i)
+        b[i] = std::sin(b[i]);
+}
+
 inline double Square::sample(double t) const {
     return std::sin(x.sample(t)) > 0 ? 1.0 : -1.0;
 }
 
+inline void Square::process(Signal::Context* ctx, const double* t, double* b, int n) const {
+    x.process(ctx, t, b, n);
+    for (int i = 0; i < n; ++i)
+        b[i] = std::sin(b[i]) > 0 ? 1.0 : -1.0;
+}
+
 inline double Saw::sample(double t) const {
     return -2 * INV_PI * std::atan(std::cos(0.5 * x.sample(t)) / std::sin(0.5 * x.sample(t)));
 }
 
+inline void Saw::process(Signal::Context* ctx, const double* t, double* b, int n) const {
+    x.process(ctx, t, b, n);
+    for (int i = 0; i < n; ++i)
+        b[i] = -2 * INV_PI * std::atan(std::cos(0.5 * b[i]) / std::sin(0.5 * b[i]));
+}
+
 inline double Triangle::sample(double t) const {
     return 2 * INV_PI * std::asin(std::sin(x.sample(t)));
 }
 
+inline void Triangle::process(Signal::Context* ctx, const double* t, double* b, int n) const {
+    x.process(ctx, t, b, n);
+    for (int i = 0; i < n; ++i)
+        b[i] = 2 * INV_PI * std::asin(std::sin(b[i]));
+}
+
 
 inline double Pwm::sample(double t) const {
     return std::fmod(t, 1.0 / frequency) * frequency < dutyCycle ? 1.0 : -1.0;
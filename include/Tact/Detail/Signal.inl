@@ -1,4 +1,7 @@
 #include <Tact/Signal.hpp>
+#ifdef SYNTACTS_VERIFY_LENGTH_CACHE
+#include <cassert>
+#endif
 
 namespace tact
 {
@@ -37,12 +40,22 @@ inline double Signal::sample(double t) const
 
 inline void Signal::sample(const double *t, double *b, int n) const
 {
-    return m_ptr->sample(t, b, n, gain, bias);
+    m_ptr->process(nullptr, t, b, n, gain, bias);
+}
+
+inline void Signal::prepare(Context& ctx) const
+{
+    m_ptr->prepare(ctx);
+}
+
+inline void Signal::process(Context* ctx, const double *t, double *b, int n) const
+{
+    m_ptr->process(ctx, t, b, n, gain, bias);
 }
 
 inline double Signal::length() const
 {
-    return m_ptr->length();
+    return m_ptr->cachedLength();
 }
 
 template <typename T>
@@ -51,8 +64,12 @@ inline bool Signal::isType() const
     return m_ptr->typeId() == typeid(T); 
 }
 
-template <typename T> inline T* Signal::getAs() const {
-    return static_cast<T*>(m_ptr->get());
+template <typename T> inline T* Signal::getAs() {
+    return static_cast<T*>(get());
+}
+
+template <typename T> inline const T* Signal::getAs() const {
+    return static_cast<const T*>(get());
 }
 
 #ifdef SYNTACTS_USE_POOL
@@ -66,8 +83,45 @@ inline int Signal::count() {
     return Concept::count();
 }
 
+inline double Signal::Concept::cachedLength() const {
+    // Signals can only be mutated through a pointer from the mutable get()/getAs(). Reaching a nested 
+    // Signal that way requires one for each of its parents too, so a Signal none was handed out for 
+    // (e.g. a copy played by a Session) has a fixed length, and an exposed one is always recomputed
+    if (m_exposed.load(std::memory_order_acquire))
+        return length();
+    if (!m_cached.load(std::memory_order_acquire)) {
+        m_length.store(length(), std::memory_order_relaxed);
+        m_cached.store(true, std::memory_order_release);
+    }
+#ifdef SYNTACTS_VERIFY_LENGTH_CACHE
+    assert(m_length.load(std::memory_order_relaxed) == length() && "stale Signal length cache");
+#endif
+    return m_length.load(std::memory_order_relaxed);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
+/// Detects if T implements block sampling, i.e. void sample(const double* t, double* b, int n) const
+template <typename T, typename = void>
+struct HasBlockSample : std::false_type { };
+
+template <typename T>
+struct HasBlockSample<T, decltype(std::declval<const T&>().sample(std::declval<const double*>(), std::declval<double*>(), 0))> : std::true_type { };
+
+/// Detects if T implements context processing, i.e. void process(Signal::Context* ctx, const double* t, double* b, int n) const
+template <typename T, typename = void>
+struct HasProcess : std::false_type { };
+
+template <typename T>
+struct HasProcess<T, decltype(std::declval<const T&>().process(std::declval<Signal::Context*>(), std::declval<const double*>(), std::declval<double*>(), 0))> : std::true_type { };
+
+/// Detects if T has per-voice state or children, i.e. void prepare(Signal::Context& ctx) const
+template <typename T, typename = void>
+struct HasPrepare : std::false_type { };
+
+template <typename T>
+struct HasPrepare<T, decltype(std::declval<const T&>().prepare(std::declval<Signal::Context&>()))> : std::true_type { };
+
 template <typename T>
 Signal::Model<T>::Model() 
 {} 
@@ -84,10 +138,29 @@ double Signal::Model<T>::sample(double t) const
 }
 
 template <typename T>
-void Signal::Model<T>::sample(const double* t, double* b, int n, double s, double o) const 
+void Signal::Model<T>::process(Context* ctx, const double* t, double* b, int n, double s, double o) const 
 { 
-    for (int i = 0; i < n; ++i) 
-        b[i] = m_model.sample(t[i]) * s + o;
+    if constexpr (HasProcess<T>::value || HasBlockSample<T>::value) {
+        if constexpr (HasProcess<T>::value)
+            m_model.process(ctx, t, b, n);
+        else
+            m_model.sample(t, b, n);
+        if (s != 1 || o != 0) {
+            for (int i = 0; i < n; ++i)
+                b[i] = b[i] * s + o;
+        }
+    }
+    else {
+        for (int i = 0; i < n; ++i) 
+            b[i] = m_model.sample(t[i]) * s + o;
+    }
+}
+
+template <typename T>
+void Signal::Model<T>::prepare(Context& ctx) const 
+{ 
+    if constexpr (HasPrepare<T>::value)
+        m_model.prepare(ctx);
 }
 
 template <typename T>
@@ -115,7 +188,6 @@ void* Signal::Model<T>::get() const
 template <typename T>
 std::unique_ptr<Signal::Concept> Signal::Model<T>::copy() const 
 { 
-    s_count++;
     return std::make_unique<Signal::Model<T>>(*this); 
 }
 
@@ -124,7 +196,6 @@ std::unique_ptr<Signal::Concept> Signal::Model<T>::copy() const
 template <typename T>
 std::unique_ptr<Signal::Concept, Signal::Deleter> Signal::Model<T>::copy() const
 { 
-    s_count++;
     return std::unique_ptr<Signal::Concept, Signal::Deleter>(new (Signal::pool().allocate()) Model(*this)); 
 }
 
@@ -133,6 +204,24 @@ std::unique_ptr<Signal::Concept, Signal::Deleter> Signal::Model<T>::copy() const
 
 ///////////////////////////////////////////////////////////////////////////////
 
+template <typename S, typename ... Args> 
+inline S& SignalContext::create(const void* owner, Args&& ... args) {
+    auto it = std::lower_bound(m_states.begin(), m_states.end(), owner, [](const auto& s, const void* o) { return s.first < o; });
+    if (it == m_states.end() || it->first != owner)
+        it = m_states.emplace(it, owner, std::make_unique<Holder<S>>(std::forward<Args>(args)...));
+    return static_cast<Holder<S>*>(it->second.get())->value;
+}
+
+template <typename S> 
+inline S* SignalContext::get(const void* owner) const {
+    auto it = std::lower_bound(m_states.begin(), m_states.end(), owner, [](const auto& s, const void* o) { return s.first < o; });
+    if (it == m_states.end() || it->first != owner)
+        return nullptr;
+    return &static_cast<Holder<S>*>(it->second.get())->value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 template <class Archive>
 void Signal::save(Archive& archive) const {
     archive(TACT_MEMBER(gain), TACT_MEMBER(bias), TACT_MEMBER(m_ptr));
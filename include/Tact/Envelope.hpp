@@ -128,6 +128,8 @@ public:
     SignalEnvelope(Signal signal = Sine(), double duration = 1.0,
                    double amplitude = 1.0);
     double sample(double t) const;
+    void process(Signal::Context* ctx, const double* t, double* b, int n) const;
+    void prepare(Signal::Context& ctx) const;
     double length() const;
 
 public:
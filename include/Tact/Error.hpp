@@ -35,5 +35,8 @@ enum SyntactsError : int {
   SyntactsError_InvalidSampleRate = -6,
   SyntactsError_NoWaveform = -7,
   SyntactsError_ControlPanelFail = -8,
-  SyntactsError_InvalidAPI = -9
+  SyntactsError_InvalidAPI = -9,
+  SyntactsError_InvalidVoiceCount = -10,
+  SyntactsError_InvalidVoice = -11,
+  SyntactsError_InvalidHandle = -12
 };
\ No newline at end of file
@@ -0,0 +1,72 @@
+// MIT License
+//
+// Copyright (c) 2020 Mechatronics and Haptic Interfaces Lab
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Author(s): Evan Pezent (epezent@rice.edu)
+
+#pragma once
+
+#include <Tact/Config.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace tact {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// Kinds of changes reported by a FileWatcher.
+enum class FileStatus {
+    Created,  ///< a file was added
+    Modified, ///< a file's contents changed
+    Erased    ///< a file was removed
+};
+
+/// Watches a directory tree for file changes on a background thread (e.g. to hot-reload Library Signals).
+/// Uses inotify on Linux and falls back to polling modification times on other platforms. Bursts of
+/// events for the same file are coalesced, so a file that is created and then written reports a single Created.
+class SYNTACTS_API FileWatcher {
+public:
+    /// Function called from the watcher thread for each changed file.
+    using Callback = std::function<void(const std::string& path, FileStatus status)>;
+
+    /// Constructor. The delay is the polling interval when events are not available from the OS.
+    FileWatcher(const std::string& watchPath, int delayMilliseconds = 1000);
+    /// Destructor. Stops the watcher thread.
+    ~FileWatcher();
+
+    /// Starts watching on a background thread. Returns false if already running or the path doesn't exist.
+    bool start(Callback action);
+    /// Stops watching and joins the watcher thread.
+    void stop();
+    /// Returns true if the watcher thread is running.
+    bool isRunning() const;
+    /// Returns true if changes are delivered by OS events rather than polling.
+    bool isEventDriven() const;
+
+private:
+    class Impl;                   ///< private implementation
+    std::unique_ptr<Impl> m_impl; ///< pointer to implementation
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace tact
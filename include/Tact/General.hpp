@@ -28,6 +28,8 @@
 #include <Tact/Util.hpp>
 #include <memory>
 #include <string>
+#include <cstdint>
+#include <vector>
 #include <random>
 #include <map>
 #include <random>
@@ -35,6 +37,8 @@
 namespace tact
 {
 
+class SignalContext;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /// A signal that simple returns the time passed to it.
@@ -80,30 +84,120 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
-/// A signal that generates white noise.
+/// A signal that generates white noise. Samples are a hash of t and a seed rather than the
+/// output of a shared generator, so Noise is thread safe. Without a Signal::Context (e.g. 
+/// plotting or exporting) the seed is used as is, so output is deterministic for a given seed.
+/// Each prepared context (i.e. each voice) derives its own seed, so voices playing the same
+/// Noise are uncorrelated, and re-derives it whenever time jumps back (e.g. a Repeater starts
+/// over) so repetitions differ.
 class SYNTACTS_API Noise
 {
 public:
     Noise();
+    Noise(std::uint64_t seed);
+    double sample(double t) const;
+    void process(SignalContext* ctx, const double* t, double* b, int n) const;
+    void prepare(SignalContext& ctx) const;
+    double length() const;
+public:
+    std::uint64_t seed; ///< each default constructed noise Signal gets a unique seed (not serialized, so loaded Signals get a new one)
+private:
+    TACT_SERIALIZABLE
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// A signal that generates pink (1/f) noise using the Voss-McCartney algorithm (seeded like Noise).
+class SYNTACTS_API PinkNoise
+{
+public:
+    PinkNoise();
+    PinkNoise(std::uint64_t seed);
     double sample(double t) const;
+    void process(SignalContext* ctx, const double* t, double* b, int n) const;
+    void prepare(SignalContext& ctx) const;
     double length() const;
+public:
+    std::uint64_t seed; ///< not serialized, so loaded Signals get a new one
 private:
     TACT_SERIALIZABLE
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
-/// A signal that returns the evaluation of an expression f(t).
+/// A signal that generates brown (1/f^2) noise (seeded like Noise).
+class SYNTACTS_API BrownNoise
+{
+public:
+    BrownNoise();
+    BrownNoise(std::uint64_t seed);
+    double sample(double t) const;
+    void process(SignalContext* ctx, const double* t, double* b, int n) const;
+    void prepare(SignalContext& ctx) const;
+    double length() const;
+public:
+    std::uint64_t seed; ///< not serialized, so loaded Signals get a new one
+private:
+    TACT_SERIALIZABLE
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// A signal that generates noise with no content above a bandwidth in Hz (seeded like Noise).
+class SYNTACTS_API BandLimitedNoise
+{
+public:
+    BandLimitedNoise(double bandwidth = 100);
+    double sample(double t) const;
+    void process(SignalContext* ctx, const double* t, double* b, int n) const;
+    void prepare(SignalContext& ctx) const;
+    double length() const;
+public:
+    double bandwidth;
+    std::uint64_t seed; ///< not serialized, so loaded Signals get a new one
+private:
+    TACT_SERIALIZE(TACT_MEMBER(bandwidth));
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// A signal that returns the evaluation of an expression f(t). Besides t, pi, and functions, an
+/// expression may only use declared variables, which can be changed while the Expression plays
+/// without recompiling it. Variables are declared in the constructor, by setVariable, or by leading
+/// declarations in the expression itself (e.g. "var amp; var freq; amp*sin(2*pi*freq*t)"). Any
+/// other identifier is a compile error. Variables are atomic, and each copy of an Expression has its
+/// own, starting from the values it was copied with. To change the variables of copies already playing,
+/// opt into sharing with shareVariables() before they are made. Changes are smoothed per voice when
+/// played by a Session; sampling without a Signal::Context uses the current values as is.
 class SYNTACTS_API Expression {
 public:
-    Expression(const std::string& expr = "sin(2*pi*100*t)");
+    Expression(const std::string& expr = "sin(2*pi*100*t)", const std::vector<std::string>& variables = {});
     Expression(const Expression& other);
     ~Expression();
     double sample(double t) const;
+    void process(SignalContext* ctx, const double* t, double* b, int n) const;
+    void prepare(SignalContext& ctx) const;
     double length() const;
     bool setExpression(const std::string& expr);
     const std::string& getExpression() const;
     bool operator=(const std::string& expr);
+    /// Sets a variable (lock-free, changes are smoothed). An undeclared name is first declared, which
+    /// recompiles the expression if it didn't compile without it. Returns false if the expression doesn't use it.
+    bool setVariable(const std::string& name, double value);
+    /// Sets a variable by its index in getVariables().
+    bool setVariable(int index, double value);
+    /// Gets the current value of a variable, or 0 if it doesn't exist.
+    double getVariable(const std::string& name) const;
+    /// Returns the names of the variables the expression uses.
+    const std::vector<std::string>& getVariables() const;
+    /// If true, copies made from now on (e.g. by Session::play) share this Expression's variables, and so
+    /// do their copies, so setVariable on any of them reaches all of them. Off by default and not serialized.
+    void shareVariables(bool share = true);
+    /// Returns true if copies of this Expression share its variables.
+    bool sharesVariables() const;
+private:
+    /// Returns the expression with variables declared through the API prepended as declarations.
+    std::string getSource() const;
 private:
     class Impl;
     std::unique_ptr<Impl> m_impl;
@@ -112,7 +206,7 @@ private:
     template<class Archive>
     void save(Archive& archive) const 
     { 
-        std::string expr = getExpression();
+        std::string expr = getSource();
         archive(TACT_MEMBER(expr)); 
     }
     template<class Archive>
@@ -126,7 +220,7 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
-/// A signal that generates white noise
+/// A Signal defined by a piecewise cubic Bezier curve, which is solved to a piecewise linear curve
 class SYNTACTS_API PolyBezier
 {
 public:
@@ -142,8 +236,10 @@ public:
     };
 public:
     double sample(double t) const;
+    void sample(const double* t, double* b, int n) const;
     double length() const;
-    void solve();
+    /// Solves the curve so the linear solution is within tolerance (distance in the t-y plane) of the Bezier curves.
+    void solve(double tolerance = 1e-4);
 public:
     std::vector<PointGroup> points;
     std::vector<Point> solution;
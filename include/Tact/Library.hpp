@@ -26,9 +26,13 @@
 
 #include <Tact/Signal.hpp>
 #include <string>
+#include <vector>
+#include <future>
 
 namespace tact {
 
+class Spatializer;
+
 /// Formats used for exporting/importing Signals.
 enum class FileFormat {
     Unknown = -1,  ///< unknown format (for internal use only)
@@ -40,6 +44,16 @@ enum class FileFormat {
     JSON = 5       ///< human readable serialized format
 };
 
+/// Hit/miss statistics for the process-wide Library Signal cache.
+struct CacheStats {
+    std::size_t hits      = 0; ///< loads served from memory
+    std::size_t misses    = 0; ///< loads which deserialized a file from disk
+    std::size_t evictions = 0; ///< entries evicted to stay under capacity
+    std::size_t entries   = 0; ///< number of Signals currently cached
+    std::size_t bytes     = 0; ///< serialized size of all cached Signals
+    std::size_t capacity  = 0; ///< maximum serialized size the cache may hold
+};
+
 namespace Library {
 
 /// Returns the directory to which all library Signals are saved/loaded (usually C:\Users\[user]\AppData\Roaming\Syntacts\Library).
@@ -54,12 +68,36 @@ bool loadSignal(Signal& signal, const std::string& name);
 /// Erases a Signal from the global Syntacts Signal library if it exists.
 bool deleteSignal(const std::string& name);
 
+/// Saves a Spatializer's channel layout and settings to the global Syntacts library.
+bool saveSpatializer(const Spatializer& spatializer, const std::string& name);
+
+/// Loads a Spatializer's channel layout and settings from the global Syntacts library (applied with a single update).
+bool loadSpatializer(Spatializer& spatializer, const std::string& name);
+
+/// Erases a Spatializer from the global Syntacts library if it exists.
+bool deleteSpatializer(const std::string& name);
+
 /// Saves a Signal as a specified file format.
 bool exportSignal(const Signal& signal, const std::string& filePath, FileFormat format = FileFormat::Auto, int sampleRate = 48000, double maxLength = 60); 
 
 /// Imports a Signal of a specific file format.
 bool importSignal(Signal& signal, const std::string& filePath, FileFormat format = FileFormat::Auto, int sampleRate = 48000);
 
+/// Loads a library Signal into the cache on a background thread so later calls to loadSignal are served from memory.
+std::future<bool> prefetchSignal(const std::string& name);
+
+/// Loads several library Signals into the cache on a background thread (e.g. at level load). Resolves true if all were loaded.
+std::future<bool> prefetchSignals(const std::vector<std::string>& names);
+
+/// Sets the maximum serialized size in bytes the Signal cache may hold, evicting least recently used Signals as needed (default 64 MB).
+void setCacheCapacity(std::size_t bytes);
+
+/// Removes all Signals from the Signal cache.
+void clearCache();
+
+/// Returns hit/miss statistics for the Signal cache.
+CacheStats getCacheStats();
+
 } // namespace Library
 
 } // namespace tact
\ No newline at end of file
@@ -34,6 +34,7 @@ namespace tact {
 struct IOperator {
     IOperator() = default;
     IOperator(Signal lhs, Signal rhs);
+    void prepare(Signal::Context& ctx) const;
 public:
     Signal lhs, rhs;
 private:
@@ -46,6 +47,7 @@ private:
 struct Sum : public IOperator {
     using IOperator::IOperator;
     double sample(double t) const;
+    void process(Signal::Context* ctx, const double* t, double* b, int n) const;
     double length() const;
 private:
     TACT_SERIALIZE(TACT_PARENT(IOperator));
@@ -57,6 +59,7 @@ private:
 struct Product : public IOperator {
     using IOperator::IOperator;
     double sample(double t) const;
+    void process(Signal::Context* ctx, const double* t, double* b, int n) const;
     double length() const;
 private:
     TACT_SERIALIZE(TACT_PARENT(IOperator));
@@ -47,6 +47,8 @@ public:
     IOscillator(double hertz, Signal modulation, double index = 2.0);
     /// Returns infinity
     inline double length() const;
+    /// Prepares the input Signal
+    void prepare(Signal::Context& ctx) const;
 public:
     Signal x; ///< the Oscillator's input.    
 private:
@@ -61,6 +63,7 @@ class SYNTACTS_API Sine : public IOscillator
 public:
     using IOscillator::IOscillator;
     inline double sample(double t) const;
+    inline void process(Signal::Context* ctx, const double* t, double* b, int n) const;
 private:
     TACT_SERIALIZE(TACT_PARENT(IOscillator));
 };
@@ -73,6 +76,7 @@ class SYNTACTS_API Square : public IOscillator
 public:
     using IOscillator::IOscillator;
     inline double sample(double t) const;
+    inline void process(Signal::Context* ctx, const double* t, double* b, int n) const;
 private:
     TACT_SERIALIZE(TACT_PARENT(IOscillator));
 };
@@ -85,6 +89,7 @@ class SYNTACTS_API Saw : public IOscillator
 public:
     using IOscillator::IOscillator;
     inline double sample(double t) const;
+    inline void process(Signal::Context* ctx, const double* t, double* b, int n) const;
 private:
     TACT_SERIALIZE(TACT_PARENT(IOscillator));
 };
@@ -97,6 +102,7 @@ class SYNTACTS_API Triangle : public IOscillator
 public:
     using IOscillator::IOscillator;
     inline double sample(double t) const;
+    inline void process(Signal::Context* ctx, const double* t, double* b, int n) const;
 private:
     TACT_SERIALIZE(TACT_PARENT(IOscillator));
 };
@@ -38,6 +38,8 @@ public:
     Repeater();
     Repeater(Signal signal, int repetitions, double delay = 0);
     double sample(double t) const;
+    void process(Signal::Context* ctx, const double* t, double* b, int n) const;
+    void prepare(Signal::Context& ctx) const;
     double length() const;
 
 public:
@@ -58,6 +60,8 @@ public:
     Stretcher();
     Stretcher(Signal signal, double factor);
     double sample(double t) const;
+    void process(Signal::Context* ctx, const double* t, double* b, int n) const;
+    void prepare(Signal::Context& ctx) const;
     double length() const;
 
 public:
@@ -76,6 +80,8 @@ public:
     Reverser();
     Reverser(Signal signal);
     double sample(double t) const;
+    void process(Signal::Context* ctx, const double* t, double* b, int n) const;
+    void prepare(Signal::Context& ctx) const;
     double length() const;
 public:
     Signal signal;
@@ -85,4 +91,52 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/// A Signal which filters another Signal with a cascade of biquad sections. Unlike other Signals,
+/// Filter has state, so it expects t to increase in even steps (as it does when played by a Session,
+/// where each voice keeps its own state in a Signal::Context). The state is reset whenever t jumps
+/// backward or skips ahead. process without a Context filters each call from a reset state, so it is
+/// thread safe but blocks are independent. sample(t) filters with state kept in the Filter (each copy
+/// keeps its own), so it is only meaningful for one caller stepping t evenly and must not be called
+/// concurrently on the same Filter.
+class SYNTACTS_API Filter {
+public:
+    /// Filter response
+    enum Type { LowPass = 0, HighPass = 1, BandPass = 2, Notch = 3 };
+public:
+    Filter();
+    Filter(Signal signal, Type type, double frequency, double q = 0.7071, int order = 2);
+    double sample(double t) const;
+    void process(Signal::Context* ctx, const double* t, double* b, int n) const;
+    void prepare(Signal::Context& ctx) const;
+    double length() const;
+public:
+    Signal signal;
+    Type type;
+    double frequency; ///< cutoff or center frequency in Hz
+    double q;         ///< quality factor (unused by low and high pass filters above order 2, which are Butterworth)
+    int order;        ///< filter order from 2 to 8, rounded down to even (each biquad section adds 2)
+private:
+    struct Section {
+        double b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+        double z1 = 0, z2 = 0;
+    };
+    static constexpr int MAX_SECTIONS = 4;
+    /// Filter state, kept per voice in a Signal::Context
+    struct State {
+        Section sections[MAX_SECTIONS];
+        double dt   = 0;                                        ///< sample interval the sections were designed for
+        double last = std::numeric_limits<double>::quiet_NaN(); ///< last t filtered
+        double designed[4] = {-1, 0, 0, 0};                     ///< type, frequency, q and order the sections were designed for
+    };
+    int sections() const;
+    void design(State& state, double dt) const;
+    void reset(State& state) const;
+    void filter(State& state, double* b, int n) const;
+    mutable State m_state; ///< state used by sample(t) (single-threaded)
+private:
+    TACT_SERIALIZE(TACT_MEMBER(signal), TACT_MEMBER(type), TACT_MEMBER(frequency), TACT_MEMBER(q), TACT_MEMBER(order));
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 } // namespace tact
\ No newline at end of file
@@ -59,6 +59,10 @@ public:
 
     /// Samples and sums all overlapping signals in the sequence at time t.
     double sample(double t) const;
+    /// Samples and sums all overlapping signals in the sequence at n times t.
+    void process(Signal::Context* ctx, const double* t, double* b, int n) const;
+    /// Prepares the Signals in the sequence.
+    void prepare(Signal::Context& ctx) const;
     /// Returns the length of the Sequence.
     double length() const;
 
@@ -31,6 +31,9 @@
 #include <Tact/Operator.hpp>
 #include <Tact/Process.hpp>
 #include <string>
+#include <cstdint>
+#include <array>
+#include <vector>
 
 namespace tact {
 
@@ -66,6 +69,59 @@ struct Device {
     int defaultSampleRate;        ///< the device's default sample rate
 };
 
+/// Determines which voice is replaced when a Signal is played on a channel with no idle voices.
+enum class VoiceStealing {
+    Oldest         = 0, ///< replace the voice that was started first
+    Quietest       = 1, ///< replace the voice with the lowest output level
+    LowestPriority = 2, ///< replace the voice with the lowest priority, unless it is higher than the new Signal's
+    None           = 3  ///< don't play the new Signal
+};
+
+/// Identifies a single Signal started with Session::play, so it can be controlled independently of other voices on its channel.
+struct VoiceId {
+    int channel = -1;                  ///< channel the Signal was played on
+    std::uint32_t id = 0;              ///< generation counted id, unique within a Session (0 if invalid)
+    int error = SyntactsError_NoError; ///< error code returned by play
+    /// Converts to the error code, so existing code using play's int return value still works
+    operator int() const { return error; }
+};
+
+/// Optional processing applied to a channel's mixed output before it is sent to the device.
+struct OutputStage {
+    bool   dcBlocker   = false; ///< remove DC offset with a first order high pass filter
+    double dcCutoff    = 5;     ///< DC blocker cutoff frequency in Hz
+    bool   eq          = false; ///< apply a peaking EQ (e.g. a cut to flatten an actuator's resonance)
+    double eqFrequency = 250;   ///< EQ center frequency in Hz
+    double eqGain      = 0;     ///< EQ gain in dB
+    double eqQ         = 1;     ///< EQ quality factor
+    bool   limiter     = false; ///< apply a look-ahead peak limiter (delays output by lookAhead)
+    double threshold   = 1;     ///< limiter ceiling between 0 and 1
+    double lookAhead   = 0.005; ///< limiter look-ahead time in seconds
+    double release     = 0.05;  ///< limiter release time in seconds
+    bool   softClip    = false; ///< saturate smoothly toward +/-1 rather than hard clipping
+};
+
+/// Distribution of durations measured on the audio thread. Bin i counts durations in [2^i, 2^(i+1)) 
+/// microseconds, except bin 0 which counts everything under 2 us and the last bin which counts the rest.
+struct Histogram {
+    static constexpr int Bins = 16;
+    std::array<std::uint64_t, Bins> counts{}; ///< durations per bin
+    std::uint64_t count = 0;                  ///< number of durations measured
+    double mean = 0;                          ///< mean duration in seconds
+    double max  = 0;                          ///< longest duration in seconds
+};
+
+/// Snapshot of a Session's real-time performance (see Session::getStats).
+struct SessionStats {
+    Histogram callback;              ///< duration of each audio callback
+    std::vector<Histogram> channels; ///< time spent rendering each channel in each callback
+    double budget       = 0;         ///< duration of audio in the most recent callback in seconds
+    int queueDepth      = 0;         ///< commands waiting at the start of the most recent callback
+    int queueDepthMax   = 0;         ///< most commands waiting at the start of any callback
+    std::uint64_t xruns = 0;         ///< buffer underflows/overflows reported by the host
+    std::vector<double> xrunTimes;   ///< seconds since the Session opened of the most recent xruns, oldest first
+};
+
 /// Encapsulates a Syntacts device Session.
 class Session {
 public:
@@ -91,12 +147,36 @@ public:
     /// Opens a specific device by index with a specified number of channels and sample rate.
     int open(int index, int channelCount, double sampleRate);
 
+    /// Opens a specific device by index with a specified number of channels, sample rate, frames per 
+    /// buffer, and suggested output latency in seconds. Use 0 to let the host choose the buffer size 
+    /// or to use the device's default low latency. Smaller buffers lower latency but cost more CPU.
+    int open(int index, int channelCount, double sampleRate, int framesPerBuffer, double latency);
+
     /// Opens a specific device with its max channels and default sample rate.
     int open(const Device& device);
 
     /// Opens a specific device with a specified number of channels and sample rate.
     int open(const Device& device, int channelCount, double sampleRate);
 
+    /// Opens a specific device with a specified number of channels, sample rate, frames per buffer, 
+    /// and suggested output latency in seconds (0 uses the defaults).
+    int open(const Device& device, int channelCount, double sampleRate, int framesPerBuffer, double latency);
+
+    /// Opens a native JACK (or PipeWire JACK) client with one output port per channel (0 for one per
+    /// physical playback port), optionally connected to the physical ports. The server's sample rate and
+    /// buffer size are used. Returns SyntactsError_InvalidAPI unless built with SYNTACTS_USE_JACK.
+    /// Experimental: the JACK backend has not yet been built in CI or run against a JACK server.
+    int openJack(int channelCount = 0, const std::string& clientName = "Syntacts", bool connect = true);
+
+    /// Opens an offline Session with no device. Audio is only produced when render() is called, so
+    /// Signals can be mixed faster (or slower) than real-time, e.g. for benchmarks or bouncing to a file.
+    int openOffline(int channelCount, double sampleRate = 48000);
+
+    /// Renders frames of every channel into one buffer per channel, applying any pending commands first.
+    /// Must not be called concurrently with other Session functions. Returns SyntactsError_NotOpen 
+    /// unless the Session was opened with openOffline.
+    int render(float** buffers, int frames);
+
     /// Closes the currently opened device.
     int close();
 
@@ -104,7 +184,33 @@ public:
     bool isOpen() const;
 
     /// Plays a signal on the specified channel of the current device.
-    int play(int channel, Signal signal);
+    VoiceId play(int channel, Signal signal);
+
+    /// Plays a signal on the specified channel with a priority used by VoiceStealing::LowestPriority.
+    VoiceId play(int channel, Signal signal, int priority);
+
+    /// Plays a signal starting at a volume and a time in seconds into the signal (e.g. to join other 
+    /// voices playing the same signal in phase).
+    VoiceId play(int channel, Signal signal, int priority, double volume, double time);
+
+    /// Stops a single voice, leaving other voices on its channel playing.
+    int stop(const VoiceId& voice);
+
+    /// Sets the volume of a single voice (multiplied by its channel's volume).
+    int setVolume(const VoiceId& voice, double volume);
+
+    /// Sets the volumes of several voices with a single command, so the audio thread applies them all 
+    /// within the same buffer. voices and volumes must be the same size.
+    int setVolumes(const std::vector<VoiceId>& voices, const std::vector<double>& volumes);
+
+    /// Sets the pitch of a single voice (multiplied by its channel's pitch).
+    int setPitch(const VoiceId& voice, double pitch);
+
+    /// Returns true if a voice is still playing (may lag commands by up to one buffer).
+    bool isPlaying(const VoiceId& voice);
+
+    /// Gets the time of a voice in seconds as of the most recent buffer, or 0 if it isn't playing.
+    double getTime(const VoiceId& voice);
 
     /// Returns true if a signal is playing on the specified channel.
     bool isPlaying(int channel);
@@ -136,6 +242,10 @@ public:
     /// Sets the volume on the specified channel of the current device.
     int setVolume(int channel, double volume);
 
+    /// Sets the volumes of several channels with a single command, so the audio thread applies them 
+    /// all within the same buffer. channels and volumes must be the same size.
+    int setVolumes(const std::vector<int>& channels, const std::vector<double>& volumes);
+
     /// Gets the volume on the specified channel of the current device.
     double getVolume(int channel);
 
@@ -148,13 +258,42 @@ public:
     /// Gets the max output level between 0 and 1 for the most recent buffer (useful for visualizations).
     double getLevel(int channel);
 
+    /// Sets the number of voices (Signals that can play in unison) on each channel (default SYNTACTS_MAX_VOICES).
+    int setMaxVoices(int voices);
+
+    /// Gets the number of voices on each channel.
+    int getMaxVoices() const;
+
+    /// Gets the number of voices currently playing on the specified channel.
+    int getVoiceCount(int channel);
+
+    /// Sets which voice is replaced when a Signal is played on a channel with no idle voices.
+    void setVoiceStealing(VoiceStealing policy);
+
+    /// Gets the current voice stealing policy.
+    VoiceStealing getVoiceStealing() const;
+
+    /// Sets the output stage of a channel, applied in order DC blocker, EQ, limiter, soft clip (must be open).
+    int setOutputStage(int channel, const OutputStage& stage);
+
+    /// Gets the output stage of a channel.
+    const OutputStage& getOutputStage(int channel) const;
+
+    /// Sets the length in seconds of the ramps that fade voices in and out when they are played,
+    /// stopped, or stolen to prevent clicks (default SYNTACTS_FADE_TIME, 0 disables).
+    int setFadeTime(double seconds);
+
+    /// Gets the length of voice fade in and out ramps in seconds.
+    double getFadeTime() const;
+
     /// Gets info for the currently opened device.
     const Device& getCurrentDevice() const;
 
     /// Gets info for the default device.
     const Device& getDefaultDevice() const;
 
-    /// Gets info for all available devices, keyed by device index.
+    /// Gets info for all available devices, keyed by device index. Devices are enumerated once while any
+    /// Session exists. Sample rates not cached on disk are probed on the first call, which may be slow.
     const std::map<int, Device>& getAvailableDevices() const; 
 
     /// Returns the number of available channels (0 if not open).
@@ -166,6 +305,20 @@ public:
     /// Returns the CPU core load (0 to 1) of the Session.
     double getCpuLoad() const;
 
+    /// Returns the actual output latency in seconds reported by the open stream (0 if not open).
+    double getLatency() const;
+
+    /// Returns the time in seconds of the audio clock, which counts the frames rendered since the 
+    /// Session opened. Use it to timestamp Spatializer waypoints.
+    double getTime() const;
+
+    /// Returns callback and per-channel render timing, command queue depth, and xruns since the 
+    /// Session was opened or stats were reset. Safe to call from any thread while playing.
+    SessionStats getStats() const;
+
+    /// Clears all stats (applied by the audio thread at the start of its next callback).
+    void resetStats();
+
     /// Opens the control panel of a device if supported.
     void openControlPanel(int index);
 
@@ -174,6 +327,19 @@ public:
     /// Returns the number of active Sessions across the entire process.
     static int count();
 
+private:
+
+    friend class Spatializer;
+
+    // Mixer-side Spatializer support, keyed by the owning Spatializer (see Spatializer::Mixer)
+    int setPanner(const void* owner, const std::vector<int>& channels, const std::vector<double>& x, const std::vector<double>& y, 
+                  const std::vector<double>& z, double radius, Curve rollOff, double wrapX, double wrapY, double wrapZ, double volume, 
+                  double targetX, double targetY, double targetZ);
+    int removePanner(const void* owner);
+    int setPannerTarget(const void* owner, double x, double y, double z);
+    int addPannerWaypoint(const void* owner, double time, double x, double y, double z);
+    int setPannerPath(const void* owner, Signal x, Signal y, Signal z);
+
 private:
 
     class Impl;                   ///< private implementation
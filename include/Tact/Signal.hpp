@@ -29,15 +29,51 @@
 #include <Tact/MemoryPool.hpp>
 #include <typeinfo>
 #include <typeindex>
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <algorithm>
 
 namespace tact
 {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/// Per-voice state for Signals that need memory between blocks (e.g. filters). Signals create 
+/// their state in prepare() on a non-audio thread and look it up in process() without allocating,
+/// so one Signal can be played by many voices without sharing state. Stateless Signals ignore it.
+class SYNTACTS_API SignalContext {
+public:
+    /// Creates state S for the Signal owner (usually this), or returns the existing state.
+    template <typename S, typename ... Args> 
+    inline S& create(const void* owner, Args&& ... args);
+    /// Gets the state S created for owner, or nullptr if there is none. Does not allocate.
+    template <typename S> 
+    inline S* get(const void* owner) const;
+    /// Returns the number of states in the SignalContext.
+    std::size_t size() const { return m_states.size(); }
+    /// Destroys all states.
+    void clear() { m_states.clear(); }
+private:
+    struct State { virtual ~State() = default; };
+    template <typename S> struct Holder : State { 
+        template <typename ... Args> Holder(Args&& ... args) : value(std::forward<Args>(args)...) { }
+        S value; 
+    };
+    std::vector<std::pair<const void*, std::unique_ptr<State>>> m_states; ///< sorted by owner
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 /// An object that returns time variant samples for a length of time.
 class SYNTACTS_API Signal {
 public:
+    /// Per-voice state passed to prepare() and process().
+    using Context = SignalContext;
+
     /// Default Constructor.
     Signal();
     /// Type Erasing Constructor.
@@ -47,17 +83,26 @@ public:
     inline double sample(double t) const;
     /// Samples the Signal at n times give by t into output buffer b.
     inline void sample(const double* t, double* b, int n) const;
-    /// Returns the length of the Signal in seconds or infinity.
+    /// Creates the per-voice state this Signal and its children need in ctx (allocates, so call before playback).
+    inline void prepare(Context& ctx) const;
+    /// Samples the Signal at n times t into b, keeping per-voice state in a prepared ctx (or the Signal's own state if nullptr).
+    inline void process(Context* ctx, const double* t, double* b, int n) const;
+    /// Returns the length of the Signal in seconds or infinity (cached unless the Signal is exposed by get()/getAs()).
     inline double length() const;
 
     /// Returns the type_index of the underlying type-erased Signal.
     std::type_index typeId() const;
     /// Returns true if the underlying type-erased Signal is type T.
     template <typename T> inline bool isType() const;
-    /// Gets a pointer to the underlying type-erased Signal type (use with caution).
-    void* get() const;
-    /// Gets a pointer to the underlying type-erased Signal, cast as type T (use with caution and only if you know the Signal is a T!).
-    template <typename T> inline T* getAs() const;
+    /// Gets a mutable pointer to the underlying type-erased Signal type (use with caution). The pointer may be kept and 
+    /// used to mutate the Signal at any time, so from now on its length is recomputed on every call (copies are cached again).
+    void* get();
+    /// Gets a read-only pointer to the underlying type-erased Signal type.
+    const void* get() const;
+    /// Gets a mutable pointer to the underlying type-erased Signal, cast as type T (use with caution and only if you know the Signal is a T!). Same caveats as get().
+    template <typename T> inline T* getAs();
+    /// Gets a read-only pointer to the underlying type-erased Signal, cast as type T (only if you know the Signal is a T!).
+    template <typename T> inline const T* getAs() const;
     
     /// Returns the current count of Signals allocated in this process.
     static inline int count();
@@ -95,10 +140,12 @@ public:
 #endif
     /// Type Erasure Concept
     struct Concept {
-        Concept() { s_count++; }
-        virtual ~Concept() { s_count--; }
+        Concept() { s_count.fetch_add(1, std::memory_order_relaxed); }
+        Concept(const Concept& other) : m_length(other.m_length.load()), m_cached(other.m_cached.load() && !other.m_exposed.load()) { s_count.fetch_add(1, std::memory_order_relaxed); }
+        virtual ~Concept() { s_count.fetch_sub(1, std::memory_order_relaxed); }
         virtual double sample(double t) const = 0;
-        virtual void sample(const double* t, double* b, int n, double s, double o) const = 0;
+        virtual void process(Context* ctx, const double* t, double* b, int n, double s, double o) const = 0;
+        virtual void prepare(Context& ctx) const = 0;
         virtual double length() const = 0;
         virtual std::type_index typeId() const = 0;
         virtual void* get() const = 0;
@@ -109,11 +156,19 @@ public:
         virtual std::unique_ptr<Concept> copy() const = 0;
 #endif
 #endif
-        static inline int count() {return s_count; }
+        static inline int count() {return s_count.load(std::memory_order_relaxed); }
+        /// Returns length(), computing it once unless the Signal has been exposed.
+        inline double cachedLength() const;
+        /// Marks the Signal as reachable through a mutable pointer, which disables its length cache.
+        inline void expose() const { m_exposed.store(true, std::memory_order_release); }
         template <class Archive>
         void serialize(Archive& archive) {}
     protected:
-        static int s_count;
+        static std::atomic<int> s_count;
+    private:
+        mutable std::atomic<double> m_length{0};
+        mutable std::atomic<bool>   m_cached{false};  ///< m_length is valid
+        mutable std::atomic<bool>   m_exposed{false}; ///< a mutable pointer was handed out by get()/getAs()
     };
     /// Type Erasure Model
     template <typename T>
@@ -121,7 +176,8 @@ public:
         Model();
         Model(T model);
         double sample(double t) const override;
-        void sample(const double* t, double* b, int n, double s, double o) const override;
+        void process(Context* ctx, const double* t, double* b, int n, double s, double o) const override;
+        void prepare(Context& ctx) const override;
         double length() const override;
         std::type_index typeId() const override;
         void* get() const override;
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <Tact/Session.hpp>
+#include <unordered_map>
 
 namespace tact
 {
@@ -33,15 +34,26 @@ namespace tact
 class SYNTACTS_API Spatializer {
 public:
 
-    // 2D Spatializer point
+    // Spatializer point (z may be left 0 for 2D layouts)
     struct Point {
-        double x,y;
+        double x,y,z = 0;
+        TACT_SERIALIZE(TACT_MEMBER(x), TACT_MEMBER(y), TACT_MEMBER(z));
+    };
+
+    /// Where channel gains are computed
+    enum Mode {
+        Control, ///< update() computes gains on the calling thread, which channels ramp to once per buffer
+        Mixer    ///< positions and roll-off live in the Session mixer, which computes gains every sample
     };
 
     /// Constructor.
     Spatializer(Session* session = nullptr);
     /// Destructor.
     ~Spatializer();
+    /// Spatializers are not copyable or movable, since a Mixer mode Session keys its panner by this.
+    Spatializer(const Spatializer&) = delete;
+    /// Spatializers are not copyable or movable.
+    Spatializer& operator=(const Spatializer&) = delete;
 
     /// Binds this Spatializer to a Session.
     void bind(Session* session);
@@ -49,14 +61,16 @@ public:
     void unbind();
 
     /// Set the position of a channel. The channel will be added if it's not already in the Spatializer.
-    void setPosition(int channel, double x, double y = 0);
+    void setPosition(int channel, double x, double y = 0, double z = 0);
     /// Set the position of a channel. The channel will be added if it's not already in the Spatializer.
     void setPosition(int channel, const Point& p);
+    /// Set the positions of several channels with a single update. Channels will be added if they're not already in the Spatializer.
+    void setPositions(const std::vector<int>& channels, const std::vector<Point>& positions);
     /// Gets the position of a channel if it is in the Spatializer.
     Point getPosition(int channel) const;
 
     /// Set the Spatialier target position.
-    void setTarget(double x, double y = 0);
+    void setTarget(double x, double y = 0, double z = 0);
     /// Set the Spatialier target position.
     void setTarget(const Point& p);
     /// Get the Spatializer target position.
@@ -69,9 +83,9 @@ public:
     void setRollOff(Curve rollOff);
     /// Get the Spatializer target roll-off method.
     Curve getRollOff() const;
-    /// Enable Spatializer wrapping for one or both axes. A value of zero disables wrapping.
-    void setWrap(double xInterval, double yInterval);
-    /// Enable Spatializer wrapping for one or both axes. A value of zero disables wrapping.
+    /// Enable Spatializer wrapping for one or more axes. A value of zero disables wrapping.
+    void setWrap(double xInterval, double yInterval, double zInterval = 0);
+    /// Enable Spatializer wrapping for one or more axes. A value of zero disables wrapping.
     void setWrap(const Point& wrapInterval);
     /// Get Spatializer wrapping intervals. 0s indicate wrapping is disabled.
     const Point& getWrap() const;
@@ -91,7 +105,7 @@ public:
 
     /// Play a Signal on the Spatializer.
     void play(Signal signal);   
-    /// Stop all Signals playing in the Spatializer.
+    /// Stop all Signals playing in the Spatializer and remove added targets.
     void stop();
 
     /// Set the global volume of the Spatializer.
@@ -104,11 +118,123 @@ public:
     /// Get the global pitch of the Spatializer.
     double getPitch() const;
 
+    /// Sets where channel gains are computed (Control by default). Mixer mode requires a bound, open 
+    /// Session and is cleared if the Session closes (call update() after reopening).
+    void setMode(Mode mode);
+    /// Gets where channel gains are computed.
+    Mode getMode() const;
+
+    /// In Mixer mode, queues a target waypoint at a time on the Session clock (see Session::getTime). 
+    /// The target moves linearly from where it is through each waypoint. In Control mode, sets the target.
+    void addWaypoint(double time, double x, double y = 0, double z = 0);
+    /// In Mixer mode, queues a target waypoint at a time on the Session clock (see Session::getTime). 
+    /// The target moves linearly from where it is through each waypoint. In Control mode, sets the target.
+    void addWaypoint(double time, const Point& p);
+    /// In Mixer mode, moves the target along x(t), y(t), z(t), where t is 0 when the path starts playing. 
+    /// The path replaces any waypoints until the next setTarget or addWaypoint. Ignored in Control mode.
+    void setPath(Signal x, Signal y = Scalar(0), Signal z = Scalar(0));
+
+    /// Adds a target that plays its own Signal on the channels within its radius, so several contact 
+    /// points can share channels. Each channel mixes the targets near it through voice volumes. While 
+    /// any targets are added, the primary target (setTarget, play) no longer sets channel volumes. 
+    /// Returns the new target's id.
+    int addTarget(const Point& p, Signal signal, double radius = 0.25, Curve rollOff = Curves::Linear(), double volume = 1);
+    /// Moves an added target.
+    void moveTarget(int id, const Point& p);
+    /// Sets the radius of an added target.
+    void setTargetRadius(int id, double r);
+    /// Sets the volume of an added target.
+    void setTargetVolume(int id, double volume);
+    /// Removes an added target and stops its Signal.
+    void removeTarget(int id);
+    /// Removes and stops all added targets.
+    void clearTargets();
+    /// Gets the position of an added target if it exists.
+    Point getTargetPosition(int id) const;
+    /// Gets the ids of all added targets.
+    std::vector<int> getTargets() const;
+
     /// Enable/disable automatic updating of pitch/volume of all channels when Spatializer target or channels change (enabled by default).
     void autoUpdate(bool enable);
     /// Explicitly update the pitch/volume of all channels in the Spatializer.
     void update();
     
+private:
+    /// A target added with addTarget and the voices it plays
+    struct Target {
+        int id;
+        Point position;
+        double radius;
+        Curve rollOff;
+        double volume;
+        Signal signal;
+        double start;                ///< Session time the target was added
+        std::vector<int> channels;   ///< channels in range as of the last update, sorted
+        std::vector<VoiceId> voices; ///< voice playing on each of those channels
+    };
+
+    /// Uniform grid of channel indices for finding the channels near a target without visiting them all
+    struct Grid {
+        double cell = 0;
+        std::array<int,3> lo{}, hi{};
+        std::unordered_map<std::int64_t, std::vector<int>> cells;
+    };
+
+    /// Returns the index of a channel in m_channels, or -1 if it isn't in the Spatializer.
+    int indexOf(int channel) const;
+    /// Returns an added target by id, or nullptr.
+    Target* findTarget(int id);
+    /// Resets the volume and pitch of every channel and stops them.
+    void release();
+    /// Recomputes the gains of the primary target.
+    void updatePrimary();
+    /// Starts, stops, and sets the volumes of the voices of an added target.
+    void updateTarget(Target& target);
+    /// Finds the indices of channels that may be within r of p.
+    void query(const Point& p, double r, std::vector<int>& indices);
+private:
+    friend class cereal::access;
+    template <class Archive>
+    void save(Archive& archive) const {
+        const auto& channels = m_channels;
+        std::vector<Point> positions(m_channels.size());
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            positions[i] = {m_x[i], m_y[i], m_z[i]};
+        const auto& target  = m_target;
+        const auto& radius  = m_radius;
+        const auto& rollOff = m_rollOff;
+        const auto& wrap    = m_wrapInterval;
+        const auto& volume  = m_volume;
+        const auto& pitch   = m_pitch;
+        int mode = m_mode;
+        archive(TACT_MEMBER(channels), TACT_MEMBER(positions), TACT_MEMBER(target), TACT_MEMBER(radius), TACT_MEMBER(rollOff),
+                TACT_MEMBER(wrap), TACT_MEMBER(volume), TACT_MEMBER(pitch), TACT_MEMBER(mode));
+    }
+    template <class Archive>
+    void load(Archive& archive) {
+        std::vector<int> channels;
+        std::vector<Point> positions;
+        Point target, wrap;
+        double radius, volume, pitch;
+        Curve rollOff;
+        int mode;
+        archive(TACT_MEMBER(channels), TACT_MEMBER(positions), TACT_MEMBER(target), TACT_MEMBER(radius), TACT_MEMBER(rollOff),
+                TACT_MEMBER(wrap), TACT_MEMBER(volume), TACT_MEMBER(pitch), TACT_MEMBER(mode));
+        // clearing releases the channels (and any panner), so the new layout is applied with a single update
+        clear();
+        m_target       = target;
+        m_radius       = radius;
+        m_rollOff      = rollOff;
+        m_wrapInterval = wrap;
+        m_volume       = volume;
+        m_mode         = static_cast<Mode>(mode);
+        bool autoUpdate = m_autoUpdate;
+        m_autoUpdate = false;
+        setPositions(channels, positions);
+        setPitch(pitch);
+        m_autoUpdate = autoUpdate;
+        update();
+    }
 private:
     Session* m_session;
     Point m_target;
@@ -118,7 +244,23 @@ private:
     Curve m_rollOff;
     bool m_autoUpdate;
     Point m_wrapInterval;
-    std::map<int,Point> m_positions;
+    Mode m_mode;
+    // channels are stored as a structure of arrays sorted by channel, so update() runs over contiguous memory
+    std::vector<int>    m_channels;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+    std::vector<double> m_gains;
+    std::vector<Target> m_targets;
+    std::vector<int>    m_nearby; ///< scratch for query()
+    // scratch for updateTarget(), kept so moving a target doesn't allocate once they've grown
+    std::vector<int>     m_scratchChannels;
+    std::vector<VoiceId> m_scratchVoices;
+    std::vector<VoiceId> m_scratchBatch;
+    std::vector<double>  m_scratchGains;
+    int  m_nextTarget;
+    Grid m_grid;
+    bool m_gridDirty;
 };
     
 } // namespace tact
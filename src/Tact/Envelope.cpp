@@ -80,6 +80,17 @@ double SignalEnvelope::sample(double t) const {
     return value;
 }
 
+void SignalEnvelope::process(Signal::Context* ctx, const double* t, double* b, int n) const {
+    signal.process(ctx, t, b, n);
+    double len = length();
+    for (int i = 0; i < n; ++i)
+        b[i] = t[i] > len ? 0.0 : remap(b[i], -1, 1, 0, amplitude);
+}
+
+void SignalEnvelope::prepare(Signal::Context& ctx) const {
+    signal.prepare(ctx);
+}
+
 double SignalEnvelope::length() const {
     return duration;
 }
@@ -0,0 +1,366 @@
+#include <Tact/FileWatcher.hpp>
+#include <filesystem>
+#include <unordered_map>
+#include <set>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace tact {
+
+namespace {
+
+/// Window over which OS events for the same file are merged before being dispatched
+constexpr int COALESCE_MS = 50;
+
+/// Accumulates file events, merging repeated events for the same path
+class EventQueue {
+public:
+    void push(const std::string& path, FileStatus status) {
+        auto it = m_index.find(path);
+        if (it == m_index.end()) {
+            m_index[path] = m_events.size();
+            m_events.push_back({path, status, true});
+            return;
+        }
+        auto& e = m_events[it->second];
+        if (e.status == FileStatus::Created && status == FileStatus::Erased)
+            e.valid = false;                    // transient file, never report it
+        else if (e.status == FileStatus::Created)
+            e.valid = true;                     // created then written is still created
+        else if (e.status == FileStatus::Erased && status != FileStatus::Erased)
+            e = {path, FileStatus::Modified, true}; // replaced (e.g. atomic save)
+        else if (status == FileStatus::Erased)
+            e = {path, FileStatus::Erased, true};
+        else if (!e.valid)
+            e = {path, status, true};
+    }
+
+    bool empty() const {
+        return m_events.empty();
+    }
+
+    void dispatch(const FileWatcher::Callback& action) {
+        for (auto& e : m_events) {
+            if (e.valid)
+                action(e.path, e.status);
+        }
+        m_events.clear();
+        m_index.clear();
+    }
+
+private:
+    struct Event {
+        std::string path;
+        FileStatus status;
+        bool valid;
+    };
+    std::vector<Event> m_events;
+    std::unordered_map<std::string, std::size_t> m_index;
+};
+
+} // private namespace
+
+class FileWatcher::Impl {
+public:
+
+    Impl(const std::string& watchPath, int delay) :
+        m_watchPath(watchPath),
+        m_delay(delay),
+        m_running(false)
+    { }
+
+    ~Impl() {
+        stop();
+    }
+
+    bool start(Callback action) {
+        if (m_running || !fs::exists(m_watchPath))
+            return false;
+        m_running = true;
+#ifdef __linux__
+        if (openInotify()) {
+            m_thread = std::thread([this, action]() { runInotify(action); });
+            return true;
+        }
+#endif
+        m_thread = std::thread([this, action]() { runPolling(action); });
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (!m_running)
+                return;
+            m_running = false;
+        }
+        m_cv.notify_all();
+#ifdef __linux__
+        if (m_wakeFd[1] != -1) {
+            char c = 0;
+            (void)!write(m_wakeFd[1], &c, 1);
+        }
+#endif
+        if (m_thread.joinable())
+            m_thread.join();
+#ifdef __linux__
+        closeInotify();
+#endif
+    }
+
+    bool isRunning() const {
+        return m_running;
+    }
+
+    bool isEventDriven() const {
+#ifdef __linux__
+        return m_fd != -1;
+#else
+        return false;
+#endif
+    }
+
+private:
+
+    /// Polling fallback: compares last write times of the entire tree every delay
+    void runPolling(Callback action) {
+        std::unordered_map<std::string, fs::file_time_type> paths;
+        std::error_code ec;
+        for (auto& file : fs::recursive_directory_iterator(m_watchPath, ec)) {
+            if (file.is_regular_file(ec))
+                paths[file.path().string()] = fs::last_write_time(file, ec);
+        }
+        EventQueue events;
+        std::unique_lock<std::mutex> lock(m_mtx);
+        while (m_running) {
+            m_cv.wait_for(lock, std::chrono::milliseconds(m_delay));
+            if (!m_running)
+                break;
+            lock.unlock();
+            for (auto it = paths.begin(); it != paths.end();) {
+                if (!fs::exists(it->first, ec)) {
+                    events.push(it->first, FileStatus::Erased);
+                    it = paths.erase(it);
+                }
+                else
+                    ++it;
+            }
+            for (auto& file : fs::recursive_directory_iterator(m_watchPath, ec)) {
+                if (!file.is_regular_file(ec))
+                    continue;
+                auto path  = file.path().string();
+                auto mtime = fs::last_write_time(file, ec);
+                auto it = paths.find(path);
+                if (it == paths.end()) {
+                    paths[path] = mtime;
+                    events.push(path, FileStatus::Created);
+                }
+                else if (it->second != mtime) {
+                    it->second = mtime;
+                    events.push(path, FileStatus::Modified);
+                }
+            }
+            events.dispatch(action);
+            lock.lock();
+        }
+    }
+
+#ifdef __linux__
+
+    bool openInotify() {
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_fd == -1)
+            return false;
+        if (pipe(m_wakeFd) == -1) {
+            m_wakeFd[0] = m_wakeFd[1] = -1;
+            closeInotify();
+            return false;
+        }
+        fcntl(m_wakeFd[0], F_SETFL, O_NONBLOCK);
+        EventQueue ignored;
+        addWatches(m_watchPath, ignored);
+        return true;
+    }
+
+    void closeInotify() {
+        for (int* fd : {&m_fd, &m_wakeFd[0], &m_wakeFd[1]}) {
+            if (*fd != -1)
+                close(*fd);
+            *fd = -1;
+        }
+        m_dirs.clear();
+        m_files.clear();
+    }
+
+    /// Watches dir and all subdirectories, reporting files found in them that weren't known as created
+    void addWatches(const std::string& dir, EventQueue& events) {
+        constexpr uint32_t mask = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF;
+        int wd = inotify_add_watch(m_fd, dir.c_str(), mask);
+        if (wd != -1)
+            m_dirs[wd] = dir;
+        std::error_code ec;
+        for (auto& entry : fs::directory_iterator(dir, ec)) {
+            if (entry.is_directory(ec))
+                addWatches(entry.path().string(), events);
+            else if (entry.is_regular_file(ec) && m_files.insert(entry.path().string()).second)
+                events.push(entry.path().string(), FileStatus::Created);
+        }
+    }
+
+    /// Stops watching a directory and its subdirectories, reporting the files known under it as erased
+    void removeWatches(const std::string& dir, EventQueue& events) {
+        std::string prefix = dir + '/';
+        for (auto it = m_dirs.begin(); it != m_dirs.end();) {
+            if (it->second == dir || it->second.compare(0, prefix.size(), prefix) == 0) {
+                inotify_rm_watch(m_fd, it->first);
+                it = m_dirs.erase(it);
+            }
+            else
+                ++it;
+        }
+        for (auto it = m_files.lower_bound(prefix); it != m_files.end() && it->compare(0, prefix.size(), prefix) == 0;) {
+            events.push(*it, FileStatus::Erased);
+            it = m_files.erase(it);
+        }
+    }
+
+    /// Rebuilds the watches and diffs the files found against the known ones (after events were lost)
+    void rescan(EventQueue& events) {
+        for (auto& dir : m_dirs)
+            inotify_rm_watch(m_fd, dir.first);
+        m_dirs.clear();
+        auto known = m_files;
+        addWatches(m_watchPath, events);
+        std::error_code ec;
+        for (auto& path : known) {
+            if (fs::is_regular_file(path, ec))
+                events.push(path, FileStatus::Modified);
+            else {
+                events.push(path, FileStatus::Erased);
+                m_files.erase(path);
+            }
+        }
+    }
+
+    void runInotify(Callback action) {
+        alignas(inotify_event) char buffer[16 * 1024];
+        EventQueue events;
+        auto deadline = std::chrono::steady_clock::now();
+        pollfd fds[2] = {{m_fd, POLLIN, 0}, {m_wakeFd[0], POLLIN, 0}};
+        while (m_running) {
+            int timeout = -1;
+            if (!events.empty()) {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+                timeout = remaining > 0 ? static_cast<int>(remaining) : 0;
+            }
+            int ready = poll(fds, 2, timeout);
+            if (!m_running)
+                break;
+            if (ready > 0 && (fds[0].revents & POLLIN)) {
+                if (events.empty())
+                    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(COALESCE_MS);
+                ssize_t len;
+                while ((len = read(m_fd, buffer, sizeof(buffer))) > 0) {
+                    for (char* p = buffer; p < buffer + len; p += sizeof(inotify_event) + reinterpret_cast<inotify_event*>(p)->len)
+                        handle(*reinterpret_cast<inotify_event*>(p), events);
+                }
+            }
+            if (!events.empty() && std::chrono::steady_clock::now() >= deadline)
+                events.dispatch(action);
+        }
+    }
+
+    void handle(const inotify_event& e, EventQueue& events) {
+        if (e.mask & IN_Q_OVERFLOW) {
+            // kernel dropped events; report vanished files as erased and conservatively the rest as modified
+            rescan(events);
+            return;
+        }
+        auto dir = m_dirs.find(e.wd);
+        if (dir == m_dirs.end())
+            return;
+        if (e.mask & (IN_DELETE_SELF | IN_IGNORED)) {
+            m_dirs.erase(dir);
+            return;
+        }
+        if (e.len == 0)
+            return;
+        std::string path = (fs::path(dir->second) / e.name).string();
+        if (e.mask & IN_ISDIR) {
+            if (e.mask & (IN_CREATE | IN_MOVED_TO))
+                addWatches(path, events);
+            else if (e.mask & (IN_DELETE | IN_MOVED_FROM))
+                removeWatches(path, events);
+            return;
+        }
+        if (e.mask & (IN_CREATE | IN_MOVED_TO)) {
+            m_files.insert(path);
+            events.push(path, FileStatus::Created);
+        }
+        else if (e.mask & IN_CLOSE_WRITE) {
+            m_files.insert(path);
+            events.push(path, FileStatus::Modified);
+        }
+        else if (e.mask & (IN_DELETE | IN_MOVED_FROM)) {
+            m_files.erase(path);
+            events.push(path, FileStatus::Erased);
+        }
+    }
+
+    int m_fd = -1;
+    int m_wakeFd[2] = {-1, -1};
+    std::unordered_map<int, std::string> m_dirs;
+    std::set<std::string> m_files; ///< files known to exist, sorted so a directory's are contiguous
+
+#endif
+
+    std::string m_watchPath;
+    int m_delay;
+    std::atomic_bool m_running;
+    std::thread m_thread;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC INTERFACE
+///////////////////////////////////////////////////////////////////////////////
+
+FileWatcher::FileWatcher(const std::string& watchPath, int delayMilliseconds) :
+    m_impl(std::make_unique<FileWatcher::Impl>(watchPath, delayMilliseconds))
+{ }
+
+FileWatcher::~FileWatcher() {
+
+}
+
+bool FileWatcher::start(Callback action) {
+    return m_impl->start(std::move(action));
+}
+
+void FileWatcher::stop() {
+    m_impl->stop();
+}
+
+bool FileWatcher::isRunning() const {
+    return m_impl->isRunning();
+}
+
+bool FileWatcher::isEventDriven() const {
+    return m_impl->isEventDriven();
+}
+
+} // namespace tact
@@ -1,8 +1,18 @@
 #include <Tact/General.hpp>
+#include <Tact/Signal.hpp>
 #include <ctime>
 #include <misc/exprtk.hpp>
 #include <iostream>
 #include <Tact/Util.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <locale>
+#include <mutex>
+#include <sstream>
 
 namespace tact
 {
@@ -23,14 +33,125 @@ Ramp::Ramp(double _initial, double _final, double _duration) : initial(_initial)
 double Ramp::sample(double t) const { return initial + rate * t; }
 double Ramp::length() const { return duration; }
 
-Noise::Noise()
+namespace {
+
+/// Update rate in Hz of the fastest octave of PinkNoise and BrownNoise
+constexpr double NOISE_RATE = 48000;
+/// Number of octaves summed by PinkNoise and BrownNoise
+constexpr int NOISE_OCTAVES = 16;
+
+/// SplitMix64 finalizer, a fast hash with good avalanche
+inline std::uint64_t mix(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/// Maps a hash to a uniformly distributed double in [-1,1)
+inline double uniform(std::uint64_t h) {
+    return static_cast<double>(h >> 11) * (1.0 / 4503599627370496.0) - 1.0;
+}
+
+inline std::uint64_t bits(double t) {
+    std::uint64_t u;
+    std::memcpy(&u, &t, sizeof(u));
+    return u;
+}
+
+std::uint64_t nextSeed() {
+    static std::atomic<std::uint64_t> counter(0);
+    return mix(counter++);
+}
+
+/// Per-voice noise state. The seed is re-derived whenever time jumps back after moving
+/// forward (e.g. a Repeater starting over), but not while time steadily decreases (a Reverser).
+struct NoiseState {
+    NoiseState(std::uint64_t seed) : seed(seed) { }
+    inline std::uint64_t next(double t) {
+        if (forward && t < last)
+            seed = mix(seed);
+        forward = t > last;
+        last = t;
+        return seed;
+    }
+    std::uint64_t seed;
+    double last  = std::numeric_limits<double>::quiet_NaN();
+    bool forward = false;
+};
+
+/// Fills b with f(t, seed), using the voice's seed if ctx was prepared for owner
+template <typename F>
+inline void processNoise(const void* owner, std::uint64_t seed, SignalContext* ctx, const double* t, double* b, int n, F f) {
+    NoiseState* state = ctx ? ctx->get<NoiseState>(owner) : nullptr;
+    if (!state) {
+        for (int i = 0; i < n; ++i)
+            b[i] = f(t[i], seed);
+        return;
+    }
+    for (int i = 0; i < n; ++i)
+        b[i] = f(t[i], state->next(t[i]));
+}
+
+/// Derives a voice's seed from a Signal's seed
+inline std::uint64_t voiceSeed(std::uint64_t seed) {
+    return mix(seed ^ nextSeed());
+}
+
+/// Sums octaves of noise where octave r is a random walk between knots 2^r samples apart
+inline double octaveNoise(double t, std::uint64_t seed, const double* weights) {
+    double p = t * NOISE_RATE;
+    double sum = 0;
+    for (int r = 0; r < NOISE_OCTAVES; ++r) {
+        double q = std::ldexp(p, -r);
+        double k = std::floor(q);
+        auto i = static_cast<std::uint64_t>(static_cast<std::int64_t>(k));
+        double y0 = uniform(mix(((i    ) << 5 | r) ^ seed));
+        double y1 = uniform(mix(((i + 1) << 5 | r) ^ seed));
+        sum += weights[r] * (y0 + (y1 - y0) * (q - k));
+    }
+    return clamp(sum, -1, 1);
+}
+
+/// Octave weights normalized so the sum has about half the RMS of one octave (rarely clipping)
+template <typename F>
+std::array<double, NOISE_OCTAVES> makeWeights(F weight) {
+    std::array<double, NOISE_OCTAVES> w;
+    double norm = 0;
+    for (int r = 0; r < NOISE_OCTAVES; ++r) {
+        w[r] = weight(r);
+        norm += w[r] * w[r];
+    }
+    for (auto& x : w)
+        x /= 2 * std::sqrt(norm);
+    return w;
+}
+
+// equal power per octave gives 1/f, power doubling per octave gives 1/f^2
+const auto PINK_WEIGHTS  = makeWeights([](int) { return 1.0; });
+const auto BROWN_WEIGHTS = makeWeights([](int r) { return std::sqrt(std::ldexp(1.0, r)); });
+
+} // private namespace
+
+Noise::Noise() : seed(nextSeed())
+{ }
+
+Noise::Noise(std::uint64_t _seed) : seed(_seed)
 { }
 
 double Noise::sample(double t) const
 {
-    static std::uniform_real_distribution<double> dist(-1,1);
-    static std::mt19937 rgen;
-    return dist(rgen);
+    return uniform(mix(bits(t) ^ seed));
+}
+
+void Noise::process(SignalContext* ctx, const double* t, double* b, int n) const 
+{
+    processNoise(this, seed, ctx, t, b, n, [](double t, std::uint64_t s) { return uniform(mix(bits(t) ^ s)); });
+}
+
+void Noise::prepare(SignalContext& ctx) const
+{
+    ctx.create<NoiseState>(this, voiceSeed(seed));
 }
 
 double Noise::length() const
@@ -38,6 +159,543 @@ double Noise::length() const
     return INF;
 }
 
+PinkNoise::PinkNoise() : seed(nextSeed())
+{ }
+
+PinkNoise::PinkNoise(std::uint64_t _seed) : seed(_seed)
+{ }
+
+double PinkNoise::sample(double t) const {
+    return octaveNoise(t, seed, PINK_WEIGHTS.data());
+}
+
+void PinkNoise::process(SignalContext* ctx, const double* t, double* b, int n) const {
+    processNoise(this, seed, ctx, t, b, n, [](double t, std::uint64_t s) { return octaveNoise(t, s, PINK_WEIGHTS.data()); });
+}
+
+void PinkNoise::prepare(SignalContext& ctx) const {
+    ctx.create<NoiseState>(this, voiceSeed(seed));
+}
+
+double PinkNoise::length() const {
+    return INF;
+}
+
+BrownNoise::BrownNoise() : seed(nextSeed())
+{ }
+
+BrownNoise::BrownNoise(std::uint64_t _seed) : seed(_seed)
+{ }
+
+double BrownNoise::sample(double t) const {
+    return octaveNoise(t, seed, BROWN_WEIGHTS.data());
+}
+
+void BrownNoise::process(SignalContext* ctx, const double* t, double* b, int n) const {
+    processNoise(this, seed, ctx, t, b, n, [](double t, std::uint64_t s) { return octaveNoise(t, s, BROWN_WEIGHTS.data()); });
+}
+
+void BrownNoise::prepare(SignalContext& ctx) const {
+    ctx.create<NoiseState>(this, voiceSeed(seed));
+}
+
+double BrownNoise::length() const {
+    return INF;
+}
+
+BandLimitedNoise::BandLimitedNoise(double _bandwidth) : bandwidth(_bandwidth), seed(nextSeed())
+{ }
+
+double BandLimitedNoise::sample(double t) const {
+    double b;
+    process(nullptr, &t, &b, 1);
+    return b;
+}
+
+void BandLimitedNoise::process(SignalContext* ctx, const double* t, double* b, int n) const {
+    // Catmull-Rom interpolation of random knots spaced at the Nyquist interval of the bandwidth
+    double rate = 2 * bandwidth;
+    processNoise(this, seed, ctx, t, b, n, [rate](double t, std::uint64_t s) {
+        double p = t * rate;
+        double k = std::floor(p);
+        double f = p - k;
+        auto j = static_cast<std::uint64_t>(static_cast<std::int64_t>(k));
+        double y0 = uniform(mix((j - 1) ^ s));
+        double y1 = uniform(mix((j    ) ^ s));
+        double y2 = uniform(mix((j + 1) ^ s));
+        double y3 = uniform(mix((j + 2) ^ s));
+        return clamp(0.5 * (2 * y1 + (y2 - y0) * f + (2 * y0 - 5 * y1 + 4 * y2 - y3) * f * f + (3 * (y1 - y2) + y3 - y0) * f * f * f), -1, 1);
+    });
+}
+
+void BandLimitedNoise::prepare(SignalContext& ctx) const {
+    ctx.create<NoiseState>(this, voiceSeed(seed));
+}
+
+double BandLimitedNoise::length() const {
+    return INF;
+}
+
+namespace {
+
+/// Operations supported by the Expression virtual machine
+enum class Op {
+    // unary
+    Neg, Sin, Cos, Tan, Asin, Acos, Atan, Sinh, Cosh, Tanh,
+    Sqrt, Exp, Log, Log10, Log2, Abs, Floor, Ceil, Round, Trunc, Sgn,
+    // binary
+    Add, Sub, Mul, Div, Mod, Pow, Min, Max, Atan2, Hypot
+};
+
+constexpr int VM_REGISTERS = 16; ///< maximum number of block registers a Program may use
+constexpr int VM_TIME      = -1; ///< operand register index referring to the time input
+constexpr int VM_CONST     = -2; ///< operand register index referring to a constant
+constexpr int VM_VARIABLE  = -3; ///< operand register index referring to variable 0 (variable k is VM_VARIABLE - k)
+constexpr int VM_VARIABLES = 8;  ///< maximum number of variables a Program may use
+
+/// Time constant in seconds over which changes to Expression variables are smoothed
+constexpr double VARIABLE_SMOOTHING = 0.005;
+
+/// Expression variables, shared between copies of an Expression so they can be set while it plays
+/// (values are atomic, so any thread may read them while the control thread sets them)
+struct Variables {
+    std::vector<std::string> names;
+    std::unique_ptr<std::atomic<double>[]> values;
+};
+
+/// Per voice (see Signal::Context) state used to smooth changes to Expression variables
+struct Smoothing {
+    Smoothing(std::size_t count) :
+        count(count),
+        values(std::make_unique<double[]>(count)),
+        lastT(std::numeric_limits<double>::quiet_NaN())
+    { }
+    std::size_t count;
+    std::unique_ptr<double[]> values;
+    double lastT;
+};
+
+/// Instruction operand, either a register, the time input, or a constant
+struct Arg {
+    int reg;
+    double val;
+};
+
+struct Instruction {
+    Op  op;
+    int dst;
+    Arg a, b;
+};
+
+inline double sgn(double x) {
+    return x > 0 ? 1.0 : x < 0 ? -1.0 : 0.0;
+}
+
+inline double evalUnary(Op op, double x) {
+    switch (op) {
+        case Op::Neg:   return -x;
+        case Op::Sin:   return std::sin(x);
+        case Op::Cos:   return std::cos(x);
+        case Op::Tan:   return std::tan(x);
+        case Op::Asin:  return std::asin(x);
+        case Op::Acos:  return std::acos(x);
+        case Op::Atan:  return std::atan(x);
+        case Op::Sinh:  return std::sinh(x);
+        case Op::Cosh:  return std::cosh(x);
+        case Op::Tanh:  return std::tanh(x);
+        case Op::Sqrt:  return std::sqrt(x);
+        case Op::Exp:   return std::exp(x);
+        case Op::Log:   return std::log(x);
+        case Op::Log10: return std::log10(x);
+        case Op::Log2:  return std::log2(x);
+        case Op::Abs:   return std::abs(x);
+        case Op::Floor: return std::floor(x);
+        case Op::Ceil:  return std::ceil(x);
+        case Op::Round: return std::round(x);
+        case Op::Trunc: return std::trunc(x);
+        case Op::Sgn:   return sgn(x);
+        default:        return 0;
+    }
+}
+
+inline double evalBinary(Op op, double x, double y) {
+    switch (op) {
+        case Op::Add:   return x + y;
+        case Op::Sub:   return x - y;
+        case Op::Mul:   return x * y;
+        case Op::Div:   return x / y;
+        case Op::Mod:   return std::fmod(x, y);
+        case Op::Pow:   return std::pow(x, y);
+        case Op::Min:   return std::min(x, y);
+        case Op::Max:   return std::max(x, y);
+        case Op::Atan2: return std::atan2(x, y);
+        case Op::Hypot: return std::hypot(x, y);
+        default:        return 0;
+    }
+}
+
+template <typename F>
+inline void unaryLoop(double* d, const double* a, int n, F f) {
+    for (int i = 0; i < n; ++i)
+        d[i] = f(a[i]);
+}
+
+template <typename F>
+inline void binaryLoop(double* d, const double* a, const double* b, double ca, double cb, int n, F f) {
+    if (a && b) {
+        for (int i = 0; i < n; ++i)
+            d[i] = f(a[i], b[i]);
+    }
+    else if (a) {
+        for (int i = 0; i < n; ++i)
+            d[i] = f(a[i], cb);
+    }
+    else {
+        for (int i = 0; i < n; ++i)
+            d[i] = f(ca, b[i]);
+    }
+}
+
+inline std::string lower(std::string name) {
+    for (auto& c : name)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return name;
+}
+
+/// Returns true if name can be declared as an Expression variable
+inline bool isVariableName(const std::string& name) {
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])) || name == "t" || name == "pi")
+        return false;
+    return std::all_of(name.begin(), name.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+}
+
+/// Parses leading "var name;" declarations, appending the (lower case) names to vars. Returns
+/// the offset of the rest of the expression, or std::string::npos if a declaration is invalid.
+std::size_t parseDeclarations(const std::string& expr, std::vector<std::string>& vars) {
+    std::size_t pos = 0;
+    auto skipSpace = [&]() {
+        while (pos < expr.size() && std::isspace(static_cast<unsigned char>(expr[pos])))
+            ++pos;
+    };
+    for (;;) {
+        skipSpace();
+        if (expr.compare(pos, 3, "var") != 0 || pos + 3 >= expr.size() || !std::isspace(static_cast<unsigned char>(expr[pos + 3])))
+            return pos;
+        pos += 3;
+        skipSpace();
+        std::size_t end = expr.find(';', pos);
+        if (end == std::string::npos)
+            return std::string::npos;
+        std::string name = expr.substr(pos, end - pos);
+        name.erase(std::find_if(name.rbegin(), name.rend(), [](char c) { return !std::isspace(static_cast<unsigned char>(c)); }).base(), name.end());
+        name = lower(name);
+        if (!isVariableName(name))
+            return std::string::npos;
+        if (std::find(vars.begin(), vars.end(), name) == vars.end())
+            vars.push_back(name);
+        pos = end + 1;
+    }
+}
+
+/// An Expression compiled to a flat program for a register machine whose registers
+/// hold blocks of samples. Programs are immutable once compiled, so they can be shared
+/// between copies of an Expression and evaluated from multiple threads at once.
+class Program {
+public:
+
+    /// Compiles an expression, returning false if it uses syntax the machine doesn't support
+    /// or identifiers other than t, pi, functions, and the declared (lower case) variables
+    bool compile(const char* expr, const std::vector<std::string>& declared) {
+        m_vars.clear();
+        m_declared = &declared;
+        m_src = expr;
+        m_pos = 0;
+        m_next = 0;
+        m_ok = true;
+        m_code.clear();
+        m_result = parseAdditive();
+        skipSpace();
+        bool ok = m_ok && m_src[m_pos] == '\0';
+        m_src = nullptr;
+        m_declared = nullptr;
+        return ok;
+    }
+
+    /// Returns the names of the variables the expression uses, in order of appearance
+    const std::vector<std::string>& variables() const {
+        return m_vars;
+    }
+
+    /// Evaluates the program at n times in t, writing the results into b. Variables ramp from
+    /// their smoothed values toward the values in vars over each block, or are used as is if
+    /// smoothing is null.
+    void eval(const double* t, double* b, int n, const Variables* vars, Smoothing* smoothing) const {
+        double regs[VM_REGISTERS][SYNTACTS_BLOCK_SIZE];
+        double vals[VM_VARIABLES][SYNTACTS_BLOCK_SIZE];
+        for (int i = 0; i < n; i += SYNTACTS_BLOCK_SIZE) {
+            int m = std::min(n - i, SYNTACTS_BLOCK_SIZE);
+            if (!m_vars.empty() && smoothing)
+                smooth(t + i, m, *vars, *smoothing, vals);
+            else if (!m_vars.empty()) {
+                for (std::size_t k = 0; k < m_vars.size(); ++k)
+                    std::fill(vals[k], vals[k] + m, vars->values[k].load(std::memory_order_relaxed));
+            }
+            run(t + i, b + i, m, regs, vals);
+        }
+    }
+
+private:
+
+    void smooth(const double* t, int n, const Variables& vars, Smoothing& smoothing, double (*vals)[SYNTACTS_BLOCK_SIZE]) const {
+        double t0 = smoothing.lastT;
+        double dt = n > 1 ? (t[n-1] - t[0]) / (n - 1) : t[0] - t0;
+        // jump straight to the target on the first block or a discontinuity in time
+        double alpha = std::isnan(t0) || t[0] < t0 || dt <= 0 ? 1 : 1 - std::exp(-dt / VARIABLE_SMOOTHING);
+        for (std::size_t k = 0; k < m_vars.size(); ++k) {
+            double target = vars.values[k].load(std::memory_order_relaxed);
+            double v = smoothing.values[k];
+            if (alpha == 1 || v == target) {
+                std::fill(vals[k], vals[k] + n, target);
+                v = target;
+            }
+            else {
+                for (int i = 0; i < n; ++i) {
+                    v += (target - v) * alpha;
+                    vals[k][i] = v;
+                }
+            }
+            smoothing.values[k] = v;
+        }
+        smoothing.lastT = t[n-1];
+    }
+
+    void run(const double* t, double* b, int n, double (*regs)[SYNTACTS_BLOCK_SIZE], double (*vals)[SYNTACTS_BLOCK_SIZE]) const {
+        auto src = [&](const Arg& a) -> const double* {
+            return a.reg >= 0 ? regs[a.reg] : a.reg == VM_TIME ? t : a.reg == VM_CONST ? nullptr : vals[VM_VARIABLE - a.reg];
+        };
+        for (auto& in : m_code) {
+            double* d = regs[in.dst];
+            const double* a = src(in.a);
+            const double* c = src(in.b);
+            switch (in.op) {
+                case Op::Neg:   unaryLoop(d, a, n, [](double x) { return -x; }); break;
+                case Op::Sin:   unaryLoop(d, a, n, [](double x) { return std::sin(x); }); break;
+                case Op::Cos:   unaryLoop(d, a, n, [](double x) { return std::cos(x); }); break;
+                case Op::Sqrt:  unaryLoop(d, a, n, [](double x) { return std::sqrt(x); }); break;
+                case Op::Exp:   unaryLoop(d, a, n, [](double x) { return std::exp(x); }); break;
+                case Op::Abs:   unaryLoop(d, a, n, [](double x) { return std::abs(x); }); break;
+                case Op::Add:   binaryLoop(d, a, c, in.a.val, in.b.val, n, [](double x, double y) { return x + y; }); break;
+                case Op::Sub:   binaryLoop(d, a, c, in.a.val, in.b.val, n, [](double x, double y) { return x - y; }); break;
+                case Op::Mul:   binaryLoop(d, a, c, in.a.val, in.b.val, n, [](double x, double y) { return x * y; }); break;
+                case Op::Div:   binaryLoop(d, a, c, in.a.val, in.b.val, n, [](double x, double y) { return x / y; }); break;
+                case Op::Pow:   binaryLoop(d, a, c, in.a.val, in.b.val, n, [](double x, double y) { return std::pow(x, y); }); break;
+                default:
+                    if (in.op < Op::Add)
+                        unaryLoop(d, a, n, [&](double x) { return evalUnary(in.op, x); });
+                    else
+                        binaryLoop(d, a, c, in.a.val, in.b.val, n, [&](double x, double y) { return evalBinary(in.op, x, y); });
+                    break;
+            }
+        }
+        if (m_result.reg == VM_CONST)
+            std::fill(b, b + n, m_result.val);
+        else
+            std::copy(src(m_result), src(m_result) + n, b);
+    }
+
+    // Recursive descent parser that emits code as it goes. Operands are kept on a
+    // register stack, so the result of any sub-expression occupies the top register.
+
+    void skipSpace() {
+        while (std::isspace(static_cast<unsigned char>(m_src[m_pos])))
+            ++m_pos;
+    }
+
+    bool accept(char c) {
+        skipSpace();
+        if (m_src[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    Arg fail() {
+        m_ok = false;
+        return {VM_CONST, 0};
+    }
+
+    void release(const Arg& a) {
+        if (a.reg >= 0)
+            m_next--;
+    }
+
+    Arg emit(Op op, Arg a, Arg b = {VM_CONST, 0}) {
+        bool binary = op >= Op::Add;
+        if (a.reg == VM_CONST && (!binary || b.reg == VM_CONST))
+            return {VM_CONST, binary ? evalBinary(op, a.val, b.val) : evalUnary(op, a.val)};
+        if (binary)
+            release(b);
+        release(a);
+        if (m_next == VM_REGISTERS)
+            return fail();
+        Arg d = {m_next++, 0};
+        m_code.push_back({op, d.reg, a, b});
+        return d;
+    }
+
+    Arg parseAdditive() {
+        Arg a = parseMultiplicative();
+        while (m_ok) {
+            if (accept('+'))
+                a = emit(Op::Add, a, parseMultiplicative());
+            else if (accept('-'))
+                a = emit(Op::Sub, a, parseMultiplicative());
+            else
+                break;
+        }
+        return a;
+    }
+
+    Arg parseMultiplicative() {
+        Arg a = parseUnary();
+        while (m_ok) {
+            if (accept('*'))
+                a = emit(Op::Mul, a, parseUnary());
+            else if (accept('/'))
+                a = emit(Op::Div, a, parseUnary());
+            else if (accept('%'))
+                a = emit(Op::Mod, a, parseUnary());
+            else
+                break;
+        }
+        return a;
+    }
+
+    Arg parseUnary() {
+        if (accept('-'))
+            return emit(Op::Neg, parseUnary());
+        if (accept('+'))
+            return parseUnary();
+        return parsePower();
+    }
+
+    // exponentiation binds tighter than negation and is right associative (-2^2 = -4, 2^3^2 = 512)
+    Arg parsePower() {
+        Arg a = parsePrimary();
+        if (m_ok && accept('^'))
+            return emit(Op::Pow, a, parseUnary());
+        return a;
+    }
+
+    Arg parsePrimary() {
+        skipSpace();
+        char c = m_src[m_pos];
+        if (accept('(')) {
+            Arg a = parseAdditive();
+            return accept(')') ? a : fail();
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+            return parseNumber();
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            std::string name;
+            while (std::isalnum(static_cast<unsigned char>(m_src[m_pos])) || m_src[m_pos] == '_')
+                name += static_cast<char>(std::tolower(static_cast<unsigned char>(m_src[m_pos++])));
+            if (name == "t")
+                return {VM_TIME, 0};
+            if (name == "pi")
+                return {VM_CONST, PI};
+            skipSpace();
+            if (m_src[m_pos] == '(')
+                return parseFunction(name);
+            return parseVariable(name);
+        }
+        return fail();
+    }
+
+    // decimal literals only, i.e. digits[.digits][e[+-]digits] (not hex, inf, or nan like strtod)
+    Arg parseNumber() {
+        auto digits = [&]() {
+            std::size_t start = m_pos;
+            while (std::isdigit(static_cast<unsigned char>(m_src[m_pos])))
+                ++m_pos;
+            return m_pos - start;
+        };
+        std::size_t start = m_pos;
+        std::size_t count = digits();
+        if (m_src[m_pos] == '.') {
+            ++m_pos;
+            count += digits();
+        }
+        if (count == 0)
+            return fail();
+        if (m_src[m_pos] == 'e' || m_src[m_pos] == 'E') {
+            ++m_pos;
+            if (m_src[m_pos] == '+' || m_src[m_pos] == '-')
+                ++m_pos;
+            if (digits() == 0)
+                return fail();
+        }
+        std::istringstream ss(std::string(m_src + start, m_src + m_pos));
+        ss.imbue(std::locale::classic());
+        double val;
+        ss >> val;
+        return ss.fail() ? fail() : Arg{VM_CONST, val};
+    }
+
+    Arg parseVariable(const std::string& name) {
+        if (std::find(m_declared->begin(), m_declared->end(), name) == m_declared->end())
+            return fail();
+        auto it = std::find(m_vars.begin(), m_vars.end(), name);
+        if (it == m_vars.end()) {
+            if (m_vars.size() == VM_VARIABLES)
+                return fail();
+            it = m_vars.insert(m_vars.end(), name);
+        }
+        return {VM_VARIABLE - static_cast<int>(it - m_vars.begin()), 0};
+    }
+
+    Arg parseFunction(const std::string& name) {
+        static const std::map<std::string, Op> unary = {
+            {"sin", Op::Sin}, {"cos", Op::Cos}, {"tan", Op::Tan}, {"asin", Op::Asin}, {"acos", Op::Acos},
+            {"atan", Op::Atan}, {"sinh", Op::Sinh}, {"cosh", Op::Cosh}, {"tanh", Op::Tanh}, {"sqrt", Op::Sqrt},
+            {"exp", Op::Exp}, {"log", Op::Log}, {"log10", Op::Log10}, {"log2", Op::Log2}, {"abs", Op::Abs},
+            {"floor", Op::Floor}, {"ceil", Op::Ceil}, {"round", Op::Round}, {"trunc", Op::Trunc}, {"sgn", Op::Sgn}
+        };
+        static const std::map<std::string, Op> binary = {
+            {"pow", Op::Pow}, {"atan2", Op::Atan2}, {"hypot", Op::Hypot}, {"min", Op::Min}, {"max", Op::Max}
+        };
+        if (!accept('('))
+            return fail();
+        Arg a = parseAdditive();
+        if (unary.count(name))
+            return accept(')') ? emit(unary.at(name), a) : fail();
+        if (!binary.count(name))
+            return fail();
+        Op op = binary.at(name);
+        bool variadic = op == Op::Min || op == Op::Max;
+        if (!accept(','))
+            return fail();
+        a = emit(op, a, parseAdditive());
+        while (variadic && m_ok && accept(','))
+            a = emit(op, a, parseAdditive());
+        return accept(')') ? a : fail();
+    }
+
+private:
+    std::vector<Instruction> m_code;
+    std::vector<std::string> m_vars;
+    Arg m_result = {VM_CONST, 0};
+    // compiler state
+    const std::vector<std::string>* m_declared = nullptr;
+    const char* m_src = nullptr;
+    std::size_t m_pos = 0;
+    int m_next = 0;
+    bool m_ok = true;
+};
+
+} // private namespace
+
 class Expression::Impl
 {
 public:
@@ -45,26 +703,154 @@ public:
 
     double sample(double t) const
     {
-        m_t = t;
-        return m_expr.value();
+        double b;
+        sample(&t, &b, 1);
+        return b;
+    }
+
+    void sample(const double* t, double* b, int n, Smoothing* smoothing = nullptr) const
+    {
+        if (m_program) {
+            // without a voice's smoothing state (or if it is stale because the expression was recompiled
+            // with other variables) variables are used unsmoothed, so no state is shared between callers
+            if (smoothing && smoothing->count != m_vars->names.size())
+                smoothing = nullptr;
+            m_program->eval(t, b, n, m_vars.get(), smoothing);
+            return;
+        }
+        // exprtk fallback for syntax the Program can't compile; it evaluates through m_t
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for (std::size_t k = 0; k < m_fallbackVars.size(); ++k)
+            *m_fallbackVars[k] = m_vars->values[k].load(std::memory_order_relaxed);
+        for (int i = 0; i < n; ++i) {
+            m_t = t[i];
+            b[i] = m_expr.value();
+        }
     }
+
     bool setExpression(const std::string &expr)
     {
         m_str = expr;
-        m_table.add_variable("t", m_t);
-        m_table.add_pi();
-        m_expr.register_symbol_table(m_table);
-        return m_parser.compile(m_str, m_expr);
+        m_valid = false;
+        m_program.reset();
+        m_fallbackVars.clear();
+        // variables declared in the expression text, then those declared through the API
+        std::vector<std::string> declared;
+        std::size_t body = parseDeclarations(expr, declared);
+        for (auto& name : m_declared) {
+            if (std::find(declared.begin(), declared.end(), name) == declared.end())
+                declared.push_back(name);
+        }
+        if (body == std::string::npos) {
+            setVariables({});
+            return false;
+        }
+        std::vector<std::string> names;
+        auto program = std::make_shared<Program>();
+        if (program->compile(expr.c_str() + body, declared)) {
+            m_program = std::move(program);
+            names = m_program->variables();
+            m_valid = true;
+        }
+        else {
+            // exprtk can't report which variables are used, so every declared one is bound
+            names = declared;
+            m_fallbackValues.assign(names.size(), 0.0);
+            m_table.clear();
+            m_table.add_variable("t", m_t);
+            m_table.add_pi();
+            for (std::size_t k = 0; k < names.size(); ++k) {
+                m_table.add_variable(names[k], m_fallbackValues[k]);
+                m_fallbackVars.push_back(&m_fallbackValues[k]);
+            }
+            m_expr = exprtk::expression<double>();
+            m_expr.register_symbol_table(m_table);
+            m_valid = m_parser.compile(expr.substr(body), m_expr);
+        }
+        setVariables(names);
+        return m_valid;
+    }
+
+    /// Declares a variable, recompiling the expression if it didn't compile without it
+    bool declare(const std::string& name, bool recompile = true)
+    {
+        std::string var = lower(name);
+        if (!isVariableName(var))
+            return false;
+        if (std::find(m_declared.begin(), m_declared.end(), var) == m_declared.end()) {
+            m_declared.push_back(var);
+            if (recompile && !m_valid)
+                setExpression(m_str);
+        }
+        return true;
     }
+
+    void copy(const Impl& other)
+    {
+        m_declared = other.m_declared;
+        m_shared = other.m_shared;
+        if (other.m_program) {
+            m_str = other.m_str;
+            m_valid = other.m_valid;
+            m_program = other.m_program;
+        }
+        else {
+            setExpression(other.m_str);
+        }
+        // copies get their own bank seeded with the current values, unless sharing was opted into
+        if (m_shared) {
+            m_vars = other.m_vars;
+        }
+        else {
+            m_vars.reset();
+            setVariables(other.m_vars->names);
+            for (std::size_t k = 0; k < other.m_vars->names.size(); ++k)
+                m_vars->values[k] = other.m_vars->values[k].load(std::memory_order_relaxed);
+        }
+    }
+
+    /// Creates a new variable bank, keeping the values of variables that already existed
+    void setVariables(const std::vector<std::string>& names) 
+    {
+        auto vars = std::make_shared<Variables>();
+        vars->names = names;
+        vars->values = std::make_unique<std::atomic<double>[]>(names.size());
+        for (std::size_t k = 0; k < names.size(); ++k) {
+            int old = m_vars ? indexOf(names[k]) : -1;
+            vars->values[k] = old == -1 ? 0.0 : m_vars->values[old].load();
+        }
+        m_vars = std::move(vars);
+    }
+
+    int indexOf(const std::string& name) const
+    {
+        auto it = std::find_if(m_vars->names.begin(), m_vars->names.end(), [&](const std::string& var) {
+            return std::equal(var.begin(), var.end(), name.begin(), name.end(), [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            });
+        });
+        return it == m_vars->names.end() ? -1 : static_cast<int>(it - m_vars->names.begin());
+    }
+
+    std::shared_ptr<const Program> m_program;
+    std::shared_ptr<Variables> m_vars;
+    std::vector<std::string> m_declared; ///< variables declared through the API rather than the expression text
+    bool m_valid = false;
+    bool m_shared = false; ///< copies share m_vars rather than copying it
+    std::vector<double> m_fallbackValues;
+    std::vector<double*> m_fallbackVars;
     exprtk::symbol_table<double> m_table;
     exprtk::expression<double> m_expr;
     exprtk::parser<double> m_parser;
     std::string m_str;
     mutable double m_t;
+    mutable std::mutex m_mtx;
 };
 
-Expression::Expression(const std::string &expr) : m_impl(std::move(std::make_unique<Expression::Impl>()))
+Expression::Expression(const std::string &expr, const std::vector<std::string>& variables) : m_impl(std::move(std::make_unique<Expression::Impl>()))
 {
+    for (auto& name : variables)
+        m_impl->declare(name, false);
     setExpression(expr);
 }
 
@@ -73,14 +859,27 @@ Expression::~Expression() {
 }
 
 Expression::Expression(const Expression& other) :
-    Expression(other.getExpression())
-{ }
+    m_impl(std::make_unique<Expression::Impl>())
+{ 
+    m_impl->copy(*other.m_impl);
+}
 
 double Expression::sample(double t) const
 {
     return m_impl->sample(t);
 }
 
+void Expression::process(SignalContext* ctx, const double* t, double* b, int n) const
+{
+    m_impl->sample(t, b, n, ctx ? ctx->get<Smoothing>(this) : nullptr);
+}
+
+void Expression::prepare(SignalContext& ctx) const
+{
+    if (m_impl->m_program)
+        ctx.create<Smoothing>(this, m_impl->m_vars->names.size());
+}
+
 double Expression::length() const
 {
     return INF;
@@ -95,23 +894,77 @@ const std::string& Expression::getExpression() const {
     return m_impl->m_str;
 }
 
+std::string Expression::getSource() const {
+    std::string source;
+    for (auto& name : m_impl->m_declared)
+        source += "var " + name + "; ";
+    return source + m_impl->m_str;
+}
+
 bool Expression::operator=(const std::string &expr)
 {
     return setExpression(expr);
 }
 
+bool Expression::setVariable(const std::string& name, double value) {
+    int index = m_impl->indexOf(name);
+    if (index == -1 && m_impl->declare(name))
+        index = m_impl->indexOf(name);
+    return setVariable(index, value);
+}
+
+bool Expression::setVariable(int index, double value) {
+    if (index < 0 || index >= static_cast<int>(m_impl->m_vars->names.size()))
+        return false;
+    m_impl->m_vars->values[index].store(value, std::memory_order_relaxed);
+    return true;
+}
+
+double Expression::getVariable(const std::string& name) const {
+    int index = m_impl->indexOf(name);
+    return index == -1 ? 0 : m_impl->m_vars->values[index].load(std::memory_order_relaxed);
+}
+
+const std::vector<std::string>& Expression::getVariables() const {
+    return m_impl->m_vars->names;
+}
+
+void Expression::shareVariables(bool share) {
+    m_impl->m_shared = share;
+}
+
+bool Expression::sharesVariables() const {
+    return m_impl->m_shared;
+}
+
 double PolyBezier::sample(double t) const {
     if (solution.size() < 2)
         return 0; 
-    else {
-        auto it = std::find_if(solution.begin(), solution.end(), [&](const Point& p){return p.t > t; } );
-        if (it == solution.begin() || it == solution.end())
-            return 0; 
-        else {
-            const Point& p0 = *(std::prev(it));
-            const Point& p1 = *it;   
-            return remap(t, p0.t, p1.t, p0.y, p1.y);         
-        }
+    auto it = std::upper_bound(solution.begin(), solution.end(), t, [](double t, const Point& p) { return t < p.t; });
+    if (it == solution.begin() || it == solution.end())
+        return 0; 
+    const Point& p0 = *(std::prev(it));
+    const Point& p1 = *it;   
+    return remap(t, p0.t, p1.t, p0.y, p1.y);         
+}
+
+void PolyBezier::sample(const double* t, double* b, int n) const {
+    if (solution.size() < 2) {
+        std::fill(b, b + n, 0.0);
+        return;
+    }
+    // cursor i is the index of the first point with p.t > t; it advances with t, so sequential 
+    // blocks cost O(1) per sample and only a backwards jump in time requires a binary search
+    std::size_t i = 0;
+    for (int j = 0; j < n; ++j) {
+        if (i == 0 || solution[i-1].t > t[j])
+            i = std::upper_bound(solution.begin(), solution.end(), t[j], [](double t, const Point& p) { return t < p.t; }) - solution.begin();
+        while (i < solution.size() && solution[i].t <= t[j])
+            ++i;
+        if (i == 0 || i == solution.size())
+            b[j] = 0;
+        else
+            b[j] = remap(t[j], solution[i-1].t, solution[i].t, solution[i-1].y, solution[i].y);
     }
 }
 
@@ -121,26 +974,45 @@ double PolyBezier::length() const {
     return 0;
 }
 
-void PolyBezier::solve() {
-    constexpr int segments = 16;
+namespace {
+
+/// Recursively subdivides a cubic Bezier until each piece is within tolerance of its chord,
+/// appending the end point of each piece to the solution
+void subdivide(const PolyBezier::Point& p0, const PolyBezier::Point& p1, const PolyBezier::Point& p2, const PolyBezier::Point& p3,
+               double tol2, int depth, std::vector<PolyBezier::Point>& solution)
+{
+    // flatness bound on the distance between the curve and its chord (Willcocks)
+    double ux = 3 * p1.t - 2 * p0.t - p3.t;
+    double uy = 3 * p1.y - 2 * p0.y - p3.y;
+    double vx = 3 * p2.t - 2 * p3.t - p0.t;
+    double vy = 3 * p2.y - 2 * p3.y - p0.y;
+    double flatness = std::max(ux * ux, vx * vx) + std::max(uy * uy, vy * vy);
+    if (depth == 0 || flatness <= 16 * tol2) {
+        // keep the solution monotonic in t even if control points make the curve fold back
+        solution.push_back({std::max(p3.t, solution.back().t), p3.y});
+        return;
+    }
+    auto mid = [](const PolyBezier::Point& a, const PolyBezier::Point& b) { 
+        return PolyBezier::Point{0.5 * (a.t + b.t), 0.5 * (a.y + b.y)}; 
+    };
+    auto p01 = mid(p0, p1), p12 = mid(p1, p2), p23 = mid(p2, p3);
+    auto p012 = mid(p01, p12), p123 = mid(p12, p23);
+    auto p0123 = mid(p012, p123);
+    subdivide(p0, p01, p012, p0123, tol2, depth - 1, solution);
+    subdivide(p0123, p123, p23, p3, tol2, depth - 1, solution);
+}
+
+} // private namespace
+
+void PolyBezier::solve(double tolerance) {
+    constexpr int maxDepth = 16;
     solution.clear();
     if (points.size() > 1) {
-        std::size_t beziers = points.size() - 1;
-        solution.reserve(segments * beziers);
-        for (int b = 0; b < beziers; ++b) {
-            for (int i = 0; i < segments; ++i) {
-                auto& l = points[b];
-                auto& r = points[b+1];
-                double t = (double)i / (double)(segments-1);
-                double u = 1.0f - t;
-                double w1 = u*u*u;
-                double w2 = 3*u*u*t;
-                double w3 = 3*u*t*t;
-                double w4 = t*t*t;
-                double x = w1*l.p.t + w2*l.cpR.t + w3*r.cpL.t + w4*r.p.t;
-                double y = w1*l.p.y + w2*l.cpR.y + w3*r.cpL.y + w4*r.p.y;
-                solution.push_back({x,y});
-            }
+        solution.push_back(points.front().p);
+        for (std::size_t b = 0; b + 1 < points.size(); ++b) {
+            auto& l = points[b];
+            auto& r = points[b+1];
+            subdivide(l.p, l.cpR, r.cpL, r.p, tolerance * tolerance, maxDepth, solution);
         }
     }
 }
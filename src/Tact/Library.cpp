@@ -9,12 +9,18 @@
 #include <Tact/Envelope.hpp>
 #include <Tact/Operator.hpp>
 #include <Tact/Process.hpp>
+#include <Tact/Spatializer.hpp>
 
 #include <fstream>
 #include <filesystem>
 #include <iostream>
 #include <cstdlib>
 #include <cctype>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <iterator>
+#include <unordered_map>
 
 #include <cereal/archives/binary.hpp>
 #include <cereal/archives/json.hpp>
@@ -35,6 +41,9 @@ CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::Scalar>);
 CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::Time>);
 CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::Ramp>);
 CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::Noise>);
+CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::PinkNoise>);
+CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::BrownNoise>);
+CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::BandLimitedNoise>);
 CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::Expression>);
 CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::PolyBezier>);
 CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::Samples>);
@@ -59,6 +68,7 @@ CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::SignalEnvelope>);
 CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::Repeater>);
 CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::Stretcher>);
 CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::Reverser>);
+CEREAL_REGISTER_TYPE(tact::Signal::Model<tact::Filter>);
 
 CEREAL_REGISTER_TYPE(tact::Curve::Model<tact::Curves::Instant>);
 CEREAL_REGISTER_TYPE(tact::Curve::Model<tact::Curves::Delayed>);
@@ -140,6 +150,147 @@ std::string getExtFromFormat(FileFormat format) {
     return "";
 }
 
+/// Process-wide cache of deserialized .sig files. Entries are keyed by file path and 
+/// validated against the file's last write time and size. If those changed, the file is
+/// re-read and its content hash compared before paying for deserialization. Entries are
+/// evicted least recently used first when their serialized size exceeds the capacity.
+class SignalCache {
+public:
+
+    static SignalCache& instance() {
+        static SignalCache cache;
+        return cache;
+    }
+
+    bool load(Signal& signal, const std::string& path) {
+        std::error_code ec;
+        auto mtime = fs::last_write_time(path, ec);
+        if (ec) {
+            erase(path);
+            return false;
+        }
+        auto size = fs::file_size(path, ec);
+        if (ec) {
+            erase(path);
+            return false;
+        }
+        // fast path: file untouched since it was cached
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            auto it = m_index.find(path);
+            if (it != m_index.end() && it->second->mtime == mtime && it->second->size == size) 
+                return hit(signal, it->second);
+        }
+        // file touched, so read it and compare contents before deserializing
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::uint64_t hash = fnv1a(bytes);
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            auto it = m_index.find(path);
+            if (it != m_index.end() && it->second->hash == hash) {
+                it->second->mtime = mtime;
+                it->second->size  = size;
+                return hit(signal, it->second);
+            }
+        }
+        Signal loaded;
+        std::istringstream stream(bytes);
+        cereal::BinaryInputArchive archive(stream);
+        archive(loaded);
+        signal = loaded;
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_stats.misses++;
+        eraseUnlocked(path);
+        if (bytes.size() <= m_stats.capacity) {
+            m_lru.push_front({path, mtime, size, hash, bytes.size(), std::move(loaded)});
+            m_index[path] = m_lru.begin();
+            m_stats.bytes += bytes.size();
+            evict();
+        }
+        return true;
+    }
+
+    void erase(const std::string& path) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        eraseUnlocked(path);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_index.clear();
+        m_lru.clear();
+        m_stats.bytes = 0;
+    }
+
+    void setCapacity(std::size_t bytes) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_stats.capacity = bytes;
+        evict();
+    }
+
+    CacheStats stats() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        CacheStats stats = m_stats;
+        stats.entries = m_lru.size();
+        return stats;
+    }
+
+private:
+
+    struct Entry {
+        std::string path;
+        fs::file_time_type mtime;
+        std::uintmax_t size;
+        std::uint64_t hash;
+        std::size_t bytes;
+        Signal signal;
+    };
+
+    SignalCache() { m_stats.capacity = 64 * 1024 * 1024; }
+
+    bool hit(Signal& signal, std::list<Entry>::iterator it) {
+        m_lru.splice(m_lru.begin(), m_lru, it);
+        m_stats.hits++;
+        signal = it->signal;
+        return true;
+    }
+
+    void eraseUnlocked(const std::string& path) {
+        auto it = m_index.find(path);
+        if (it != m_index.end()) {
+            m_stats.bytes -= it->second->bytes;
+            m_lru.erase(it->second);
+            m_index.erase(it);
+        }
+    }
+
+    void evict() {
+        while (m_stats.bytes > m_stats.capacity && !m_lru.empty()) {
+            m_stats.bytes -= m_lru.back().bytes;
+            m_index.erase(m_lru.back().path);
+            m_lru.pop_back();
+            m_stats.evictions++;
+        }
+    }
+
+    static std::uint64_t fnv1a(const std::string& bytes) {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : bytes) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::mutex m_mtx;
+    std::list<Entry> m_lru; ///< most recently used at front
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+    CacheStats m_stats;
+};
+
 bool ensureDirectoryExists(fs::path path) {
     if (fs::exists(path) || path.empty())
         return true;
@@ -174,15 +325,26 @@ bool saveSignalEx(const Signal& signal, const std::string& dir, const std::strin
     try
     {
         ensureDirectoryExists(dir);
-        std::ofstream file;
-        file.open(dir + name + ".sig", std::ios::binary);
-        if (file)
+        // write to a temporary file and rename it over the old one, so a concurrent load never
+        // reads a partial file, and invalidate the cache only once the new file is in place
+        std::string path = dir + name + ".sig";
+        std::string temp = path + ".tmp";
         {
+            std::ofstream file;
+            file.open(temp, std::ios::binary);
+            if (!file)
+                return false;
             cereal::BinaryOutputArchive archive(file);
             archive(signal);
-            return true;
         }
-        return false;
+        std::error_code ec;
+        fs::rename(temp, path, ec);
+        SignalCache::instance().erase(path);
+        if (ec) {
+            fs::remove(temp, ec);
+            return false;
+        }
+        return true;
     }
     catch (cereal::Exception e)
     {
@@ -200,15 +362,7 @@ bool loadSignalEx(Signal &signal, const std::string& dir, const std::string &nam
 {
     try
     {
-        std::ifstream file;
-        file.open(dir + name + ".sig", std::ios::binary);
-        if (file)
-        {
-            cereal::BinaryInputArchive archive(file);
-            archive(signal);
-            return true;
-        }
-        return false;
+        return SignalCache::instance().load(signal, dir + name + ".sig");
     }
     catch (cereal::Exception e)
     {
@@ -235,9 +389,65 @@ bool loadSignal(Signal &signal, const std::string &name)
 
 bool deleteSignal(const std::string& name) {
     auto path = getLibraryDirectory() + name + ".sig";
+    SignalCache::instance().erase(path);
     return fs::remove(path);
 }
 
+bool saveSpatializer(const Spatializer& spatializer, const std::string& name) {
+    try
+    {
+        ensureDirectoryExists(getLibraryDirectory());
+        std::ofstream file;
+        file.open(getLibraryDirectory() + name + ".spat", std::ios::binary);
+        if (file)
+        {
+            cereal::BinaryOutputArchive archive(file);
+            archive(spatializer);
+            return true;
+        }
+        return false;
+    }
+    catch (cereal::Exception e)
+    {
+        std::cout << e.what() << std::endl;
+        return false;
+    }
+    catch (...)
+    {
+        std::cout << "Unhandled Exception!" << std::endl;
+        return false;
+    }
+}
+
+bool loadSpatializer(Spatializer& spatializer, const std::string& name) {
+    try
+    {
+        std::ifstream file;
+        file.open(getLibraryDirectory() + name + ".spat", std::ios::binary);
+        if (file)
+        {
+            cereal::BinaryInputArchive archive(file);
+            archive(spatializer);
+            return true;
+        }
+        return false;
+    }
+    catch (cereal::Exception e)
+    {
+        std::cout << e.what() << std::endl;
+        return false;
+    }
+    catch (...)
+    {
+        std::cout << "Unhandled Exception!" << std::endl;
+        return false;
+    }
+}
+
+bool deleteSpatializer(const std::string& name) {
+    return fs::remove(getLibraryDirectory() + name + ".spat");
+}
+
 bool exportSignal(const Signal &signal, const std::string &filePath, FileFormat format, int sampleRate, double maxLength)
 {
     if (format == FileFormat::Unknown) {
@@ -284,11 +494,16 @@ bool exportSignal(const Signal &signal, const std::string &filePath, FileFormat
         double sampleLength = 1.0 / sampleRate;
         auto length = signal.length() > maxLength ? maxLength : signal.length();
         std::vector<double> buffer(static_cast<std::size_t>(length * sampleRate));
-        double t = 0;
-        for (auto &sample : buffer)
+        // render through a Context like a voice would, so stateful Signals (e.g. Filter) keep their own state
+        Signal::Context ctx;
+        signal.prepare(ctx);
+        std::vector<double> times(std::min<std::size_t>(buffer.size(), 1024));
+        for (std::size_t i = 0; i < buffer.size(); i += times.size())
         {
-            sample = signal.sample(t);
-            t += sampleLength;
+            int n = static_cast<int>(std::min(times.size(), buffer.size() - i));
+            for (int j = 0; j < n; ++j)
+                times[j] = (i + j) * sampleLength;
+            signal.process(&ctx, times.data(), buffer.data() + i, n);
         }
 
         if (format == FileFormat::WAV || format == FileFormat::AIFF)
@@ -396,6 +611,35 @@ bool importSignal(Signal &signal, const std::string &filePath, FileFormat format
     }
 }
 
+std::future<bool> prefetchSignal(const std::string& name) {
+    return std::async(std::launch::async, [name]() {
+        Signal signal;
+        return loadSignal(signal, name);
+    });
+}
+
+std::future<bool> prefetchSignals(const std::vector<std::string>& names) {
+    return std::async(std::launch::async, [names]() {
+        bool all = true;
+        Signal signal;
+        for (auto& name : names)
+            all = loadSignal(signal, name) && all;
+        return all;
+    });
+}
+
+void setCacheCapacity(std::size_t bytes) {
+    SignalCache::instance().setCapacity(bytes);
+}
+
+void clearCache() {
+    SignalCache::instance().clear();
+}
+
+CacheStats getCacheStats() {
+    return SignalCache::instance().stats();
+}
+
 } // namespace Library
 
 } // namespace tact
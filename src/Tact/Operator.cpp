@@ -8,10 +8,26 @@ IOperator::IOperator(Signal _lhs, Signal _rhs) :
     lhs(std::move(_lhs)), rhs(std::move(_rhs))
 { }
 
+void IOperator::prepare(Signal::Context& ctx) const {
+    lhs.prepare(ctx);
+    rhs.prepare(ctx);
+}
+
 double Sum::sample(double t) const {
     return lhs.sample(t) + rhs.sample(t);
 }
 
+void Sum::process(Signal::Context* ctx, const double* t, double* b, int n) const {
+    double tmp[SYNTACTS_BLOCK_SIZE];
+    lhs.process(ctx, t, b, n);
+    for (int i = 0; i < n; i += SYNTACTS_BLOCK_SIZE) {
+        int m = std::min(n - i, SYNTACTS_BLOCK_SIZE);
+        rhs.process(ctx, t + i, tmp, m);
+        for (int j = 0; j < m; ++j)
+            b[i + j] += tmp[j];
+    }
+}
+
 double Sum::length() const {
     return std::max(lhs.length(), rhs.length());
 }
@@ -20,6 +36,17 @@ double Product::sample(double t) const {
     return lhs.sample(t) * rhs.sample(t);
 }
 
+void Product::process(Signal::Context* ctx, const double* t, double* b, int n) const {
+    double tmp[SYNTACTS_BLOCK_SIZE];
+    lhs.process(ctx, t, b, n);
+    for (int i = 0; i < n; i += SYNTACTS_BLOCK_SIZE) {
+        int m = std::min(n - i, SYNTACTS_BLOCK_SIZE);
+        rhs.process(ctx, t + i, tmp, m);
+        for (int j = 0; j < m; ++j)
+            b[i + j] *= tmp[j];
+    }
+}
+
 double Product::length() const {
     return std::min(lhs.length(), rhs.length());
 }
@@ -24,6 +24,10 @@ IOscillator::IOscillator(double hertz, Signal modulation, double index) :
     x(std::move(TWO_PI * hertz * Time() + index * modulation))
 { }
 
+void IOscillator::prepare(Signal::Context& ctx) const {
+    x.prepare(ctx);
+}
+
 Pwm::Pwm(double _frequency, double _dutyCycle) :
     frequency(_frequency), 
     dutyCycle(clamp01(_dutyCycle))
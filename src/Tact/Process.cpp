@@ -1,4 +1,5 @@
 #include <Tact/Process.hpp>
+#include <algorithm>
 
 namespace tact
 {
@@ -31,6 +32,38 @@ double Repeater::sample(double t) const
     return 0;
 }
 
+void Repeater::process(Signal::Context* ctx, const double* t, double* b, int n) const
+{
+    double sigLen = signal.length();
+    double intLen = sigLen + delay;
+    double maxLen = sigLen * repetitions + delay * (repetitions - 1);
+    double s[SYNTACTS_BLOCK_SIZE];
+    bool in[SYNTACTS_BLOCK_SIZE];
+    for (int i = 0; i < n; i += SYNTACTS_BLOCK_SIZE) {
+        int m = std::min(n - i, SYNTACTS_BLOCK_SIZE);
+        for (int j = 0; j < m; ++j) {
+            s[j] = std::fmod(t[i + j], intLen);
+            in[j] = t[i + j] <= maxLen && s[j] <= sigLen;
+        }
+        // sample the child once for each contiguous run of samples that fall in a repetition
+        for (int j = 0; j < m;) {
+            int k = j;
+            while (k < m && in[k] == in[j])
+                ++k;
+            if (in[j])
+                signal.process(ctx, s + j, b + i + j, k - j);
+            else
+                std::fill(b + i + j, b + i + k, 0.0);
+            j = k;
+        }
+    }
+}
+
+void Repeater::prepare(Signal::Context& ctx) const
+{
+    signal.prepare(ctx);
+}
+
 double Repeater::length() const
 {
     return signal.length() * repetitions + delay * (repetitions - 1);
@@ -48,6 +81,22 @@ double Stretcher::sample(double t) const
     return signal.sample(t / factor);
 }
 
+void Stretcher::process(Signal::Context* ctx, const double* t, double* b, int n) const
+{
+    double s[SYNTACTS_BLOCK_SIZE];
+    for (int i = 0; i < n; i += SYNTACTS_BLOCK_SIZE) {
+        int m = std::min(n - i, SYNTACTS_BLOCK_SIZE);
+        for (int j = 0; j < m; ++j)
+            s[j] = t[i + j] / factor;
+        signal.process(ctx, s, b + i, m);
+    }
+}
+
+void Stretcher::prepare(Signal::Context& ctx) const
+{
+    signal.prepare(ctx);
+}
+
 double Stretcher::length() const
 {
     return signal.length() * factor;
@@ -69,9 +118,188 @@ double Reverser::sample(double t) const
     return signal.sample(t);
 }
 
+void Reverser::process(Signal::Context* ctx, const double* t, double* b, int n) const
+{
+    double l = signal.length();
+    l = l == INF ? 1000000000 : l;
+    double s[SYNTACTS_BLOCK_SIZE];
+    for (int i = 0; i < n; i += SYNTACTS_BLOCK_SIZE) {
+        int m = std::min(n - i, SYNTACTS_BLOCK_SIZE);
+        for (int j = 0; j < m; ++j)
+            s[j] = clamp(l - t[i + j], 0, 1000000000);
+        signal.process(ctx, s, b + i, m);
+    }
+}
+
+void Reverser::prepare(Signal::Context& ctx) const
+{
+    signal.prepare(ctx);
+}
+
 double Reverser::length() const
 {
     return signal.length();
 }
 
+Filter::Filter() : type(LowPass),
+                   frequency(100),
+                   q(0.7071),
+                   order(2)
+{
+}
+
+Filter::Filter(Signal _signal, Type _type, double _frequency, double _q, int _order) : signal(std::move(_signal)),
+                                                                                        type(_type),
+                                                                                        frequency(_frequency),
+                                                                                        q(_q),
+                                                                                        order(_order)
+{
+}
+
+double Filter::sample(double t) const
+{
+    double x = signal.sample(t);
+    auto& st = m_state;
+    if (!(t > st.last) || (st.dt > 0 && t - st.last > 2 * st.dt))
+    {
+        // discontinuity; the step to the next t gives the sample interval
+        reset(st);
+        st.last = t;
+        if (st.dt > 0)
+            filter(st, &x, 1);
+        return x;
+    }
+    design(st, t - st.last);
+    st.last = t;
+    filter(st, &x, 1);
+    return x;
+}
+
+void Filter::process(Signal::Context* ctx, const double* t, double* b, int n) const
+{
+    if (n == 0)
+        return;
+    State* state = ctx ? ctx->get<State>(this) : nullptr;
+    State local;
+    auto& st = state ? *state : local;
+    signal.process(ctx, t, b, n);
+    design(st, n > 1 ? t[1] - t[0] : t[0] - st.last);
+    // filter contiguous runs of t, resetting at discontinuities
+    int start = 0;
+    double last = st.last;
+    for (int i = 0; i < n; ++i)
+    {
+        if (!(t[i] > last) || t[i] - last > 2 * st.dt)
+        {
+            filter(st, b + start, i - start);
+            reset(st);
+            start = i;
+        }
+        last = t[i];
+    }
+    filter(st, b + start, n - start);
+    st.last = t[n - 1];
+}
+
+void Filter::prepare(Signal::Context& ctx) const
+{
+    ctx.create<State>(this);
+    signal.prepare(ctx);
+}
+
+double Filter::length() const
+{
+    return signal.length();
+}
+
+int Filter::sections() const
+{
+    return std::max(1, std::min(order / 2, MAX_SECTIONS));
+}
+
+void Filter::design(State& st, double dt) const
+{
+    if (!(dt > 0))
+        return;
+    // only redesign when parameters change or the sample interval drifts (e.g. pitch changes)
+    if (std::abs(dt - st.dt) <= 1e-6 * st.dt && st.designed[0] == type && st.designed[1] == frequency &&
+        st.designed[2] == q && st.designed[3] == order)
+        return;
+    st.dt = dt;
+    st.designed[0] = type;
+    st.designed[1] = frequency;
+    st.designed[2] = q;
+    st.designed[3] = order;
+    int N = sections();
+    double w = TWO_PI * clamp(frequency, 1e-3, 0.49 / dt) * dt;
+    double cosw = std::cos(w);
+    double sinw = std::sin(w);
+    for (int k = 0; k < N; ++k)
+    {
+        // RBJ Audio EQ Cookbook biquads; cascaded low/high pass sections use Butterworth Qs
+        double Q = q;
+        if (N > 1 && (type == LowPass || type == HighPass))
+            Q = 1.0 / (2.0 * std::cos(PI * (2 * k + 1) / (4.0 * N)));
+        double alpha = sinw / (2.0 * std::max(Q, 0.01));
+        double a0 = 1 + alpha;
+        auto& s = st.sections[k];
+        switch (type)
+        {
+        case LowPass:
+            s.b0 = (1 - cosw) / 2;
+            s.b1 = 1 - cosw;
+            s.b2 = (1 - cosw) / 2;
+            break;
+        case HighPass:
+            s.b0 = (1 + cosw) / 2;
+            s.b1 = -(1 + cosw);
+            s.b2 = (1 + cosw) / 2;
+            break;
+        case BandPass:
+            s.b0 = alpha;
+            s.b1 = 0;
+            s.b2 = -alpha;
+            break;
+        case Notch:
+            s.b0 = 1;
+            s.b1 = -2 * cosw;
+            s.b2 = 1;
+            break;
+        }
+        s.a1 = -2 * cosw / a0;
+        s.a2 = (1 - alpha) / a0;
+        s.b0 /= a0;
+        s.b1 /= a0;
+        s.b2 /= a0;
+    }
+}
+
+void Filter::reset(State& st) const
+{
+    for (auto& s : st.sections)
+        s.z1 = s.z2 = 0;
+}
+
+void Filter::filter(State& st, double* b, int n) const
+{
+    // one section at a time over the whole run (transposed direct form II)
+    int N = sections();
+    for (int k = 0; k < N; ++k)
+    {
+        auto& s = st.sections[k];
+        double z1 = s.z1, z2 = s.z2;
+        for (int i = 0; i < n; ++i)
+        {
+            double x = b[i];
+            double y = s.b0 * x + z1;
+            z1 = s.b1 * x - s.a1 * y + z2;
+            z2 = s.b2 * x - s.a2 * y;
+            b[i] = y;
+        }
+        // flush before the state decays to denormals
+        s.z1 = std::abs(z1) < 1e-20 ? 0 : z1;
+        s.z2 = std::abs(z2) < 1e-20 ? 0 : z2;
+    }
+}
+
 } // namespace tact
@@ -48,6 +48,38 @@ double Sequence::sample(double t) const {
     return sample;
 }
 
+void Sequence::process(Signal::Context* ctx, const double* t, double* b, int n) const {
+    std::fill(b, b + n, 0.0);
+    double s[SYNTACTS_BLOCK_SIZE];
+    double tmp[SYNTACTS_BLOCK_SIZE];
+    for (auto& k : m_keys) {
+        double end = k.t + k.signal.length();
+        for (int i = 0; i < n; i += SYNTACTS_BLOCK_SIZE) {
+            int m = std::min(n - i, SYNTACTS_BLOCK_SIZE);
+            // sample the key once for each contiguous run of samples it overlaps
+            for (int j = 0; j < m;) {
+                bool in = t[i + j] >= k.t && t[i + j] <= end;
+                int r = j;
+                while (r < m && (t[i + r] >= k.t && t[i + r] <= end) == in)
+                    ++r;
+                if (in) {
+                    for (int q = j; q < r; ++q)
+                        s[q] = t[i + q] - k.t;
+                    k.signal.process(ctx, s + j, tmp + j, r - j);
+                    for (int q = j; q < r; ++q)
+                        b[i + q] += tmp[q];
+                }
+                j = r;
+            }
+        }
+    }
+}
+
+void Sequence::prepare(Signal::Context& ctx) const {
+    for (auto& k : m_keys)
+        k.signal.prepare(ctx);
+}
+
 double Sequence::length() const {
     return m_length;
 }
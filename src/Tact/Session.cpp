@@ -5,6 +5,12 @@
 #include "pa_asio.h"
 #include "pa_win_wasapi.h"
 #include "pa_win_ds.h"
+#ifdef SYNTACTS_USE_JACK
+#include <jack/jack.h>
+#include <jack/thread.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
 #include <algorithm>
 #include <functional>
 #include <thread>
@@ -13,6 +19,11 @@
 #include <set>
 #include <numeric>
 #include <array>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <filesystem>
+#include <chrono>
 
 namespace tact {
 
@@ -37,28 +48,319 @@ using namespace rigtorp;
 
 struct Voice {
     Signal signal;
-    double time  = 0;
-    bool stopped = true;
-    inline double step(double dt) {
-        double s = signal.sample(time) * (!stopped);
-        time += dt;
-        return s;
-    }    
+    Signal::Context context; ///< per-voice state of signal, prepared on the control thread
+    std::uint32_t id = 0; ///< VoiceId::id of the playing Signal, 0 if idle or releasing
+    double time       = 0;
+    double level      = 0; ///< peak output of the most recent buffer
+    double volume     = 1;
+    double lastVolume = 1;
+    double pitch      = 1;
+    double fade       = 1; ///< declick gain
+    double fadeStep   = 0; ///< per sample change in fade (> 0 starting, < 0 releasing)
+    int    priority   = 0;
+};
+
+/// State of a voice published by the audio thread for lock-free queries
+struct VoiceStatus {
+    std::atomic<std::uint32_t> id{0};
+    std::atomic<double>        time{0};
+};
+
+/// Transposed direct form II biquad filter
+struct Biquad {
+    double b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+    double z1 = 0, z2 = 0;
+
+    /// Makes a peaking EQ (RBJ Audio EQ Cookbook)
+    void peaking(double frequency, double gainDb, double q, double sampleRate) {
+        double A     = std::pow(10.0, gainDb / 40.0);
+        double w     = TWO_PI * clamp(frequency, 1.0, 0.49 * sampleRate) / sampleRate;
+        double alpha = std::sin(w) / (2.0 * std::max(q, 0.01));
+        double a0    = 1.0 + alpha / A;
+        b0 = (1.0 + alpha * A) / a0;
+        b1 = -2.0 * std::cos(w) / a0;
+        b2 = (1.0 - alpha * A) / a0;
+        a1 = b1;
+        a2 = (1.0 - alpha / A) / a0;
+    }
+
+    inline double process(double x) {
+        double y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        return y;
+    }
+};
+
+/// Applies an OutputStage to a channel (DC blocker -> EQ -> look-ahead limiter -> soft clipper).
+/// All memory is allocated in the constructor, which runs on the control thread.
+class OutputProcessor {
+public:
+    OutputProcessor(const OutputStage& stage, double sampleRate) :
+        m_stage(stage),
+        m_delay(std::max(1, static_cast<int>(std::round(stage.lookAhead * sampleRate)))),
+        m_buffer(m_delay, 0.0),
+        m_peaks(m_delay + 1, 0.0),
+        m_times(m_delay + 1, 0)
+    { 
+        m_dcR = clamp01(1.0 - TWO_PI * stage.dcCutoff / sampleRate);
+        m_eq.peaking(stage.eqFrequency, stage.eqGain, stage.eqQ, sampleRate);
+        m_threshold = clamp(stage.threshold, 0.001, 1.0);
+        // attack settles within the look-ahead window so peaks are caught before they are output
+        m_attack  = 1.0 - std::exp(-5.0 / m_delay);
+        m_release = 1.0 - std::exp(-1.0 / std::max(1.0, stage.release * sampleRate));
+    }
+
+    void process(double* x, int n) {
+        if (m_stage.dcBlocker) {
+            for (int i = 0; i < n; ++i) {
+                double y = x[i] - m_dcX + m_dcR * m_dcY;
+                m_dcX = x[i];
+                m_dcY = y;
+                x[i]  = y;
+            }
+            flushDenormal(m_dcY);
+        }
+        if (m_stage.eq) {
+            for (int i = 0; i < n; ++i)
+                x[i] = m_eq.process(x[i]);
+            flushDenormal(m_eq.z1);
+            flushDenormal(m_eq.z2);
+        }
+        if (m_stage.limiter) {
+            for (int i = 0; i < n; ++i)
+                x[i] = limit(x[i]);
+        }
+        if (m_stage.softClip) {
+            // cubic saturation, smooth at +/-1.5 where it reaches +/-1
+            for (int i = 0; i < n; ++i) {
+                double y = clamp(x[i], -1.5, 1.5);
+                x[i] = y - (4.0 / 27.0) * y * y * y;
+            }
+        }
+    }
+
+private:
+
+    /// Zeros decaying filter state before it becomes denormal (which is very slow on x86)
+    static inline void flushDenormal(double& z) {
+        if (std::abs(z) < 1e-20)
+            z = 0;
+    }
+
+    /// Delays x by the look-ahead time and scales it so the peak over the window doesn't exceed the threshold
+    inline double limit(double x) {
+        // sliding window max of |x| (monotonic queue in a ring of m_delay + 1)
+        int cap = m_delay + 1;
+        double a = std::abs(x);
+        while (m_size > 0 && m_peaks[(m_head + m_size - 1) % cap] <= a)
+            --m_size;
+        m_peaks[(m_head + m_size) % cap] = a;
+        m_times[(m_head + m_size) % cap] = m_count;
+        ++m_size;
+        while (m_times[m_head] + m_delay < m_count) {
+            m_head = (m_head + 1) % cap;
+            --m_size;
+        }
+        double peak   = m_peaks[m_head];
+        double target = peak > m_threshold ? m_threshold / peak : 1.0;
+        m_gain += (target - m_gain) * (target < m_gain ? m_attack : m_release);
+        double y = m_buffer[m_pos];
+        m_buffer[m_pos] = x;
+        m_pos = (m_pos + 1) % m_delay;
+        ++m_count;
+        return clamp(y * m_gain, -m_threshold, m_threshold);
+    }
+
+    OutputStage m_stage;
+    double m_dcR = 0, m_dcX = 0, m_dcY = 0;
+    Biquad m_eq;
+    double m_threshold = 1, m_attack = 1, m_release = 1, m_gain = 1;
+    int m_delay;
+    int m_pos = 0, m_head = 0, m_size = 0;
+    std::uint64_t m_count = 0;
+    std::vector<double> m_buffer;
+    std::vector<double> m_peaks;
+    std::vector<std::uint64_t> m_times;
+};
+
+/// Mixer-side state of a Spatializer, shared by the channels it positions. The target follows
+/// timestamped waypoints or an x(t),y(t),z(t) path and is evaluated once per sample of each buffer.
+struct Panner {
+    struct Waypoint {
+        double time, x, y, z;
+    };
+
+    static constexpr int MAX_WAYPOINTS = 256;
+    static constexpr unsigned long MAX_FRAMES = 8192; ///< longer buffers hold the last target
+
+    Panner() : tx(MAX_FRAMES), ty(MAX_FRAMES), tz(MAX_FRAMES) {
+        waypoints.reserve(MAX_WAYPOINTS);
+    }
+
+    std::vector<int> channels; ///< channels positioned by this Panner (control thread only)
+    double radius = 0.25;
+    double volume = 1;
+    double wrapX  = 0;
+    double wrapY  = 0;
+    double wrapZ  = 0;
+    Curve  rollOff;
+    std::vector<Waypoint> waypoints; ///< pending waypoints sorted by time
+    Waypoint anchor = {0, 0.5, 0.5, 0}; ///< where the target moves to the next waypoint from
+    Waypoint target = {0, 0.5, 0.5, 0}; ///< most recently evaluated target
+    bool followPath = false;
+    Signal pathX, pathY, pathZ;
+    Signal::Context contextX, contextY, contextZ;
+    double pathStart = -1;          ///< time the path started (< 0 until it reaches the audio thread)
+    std::vector<double> tx, ty, tz; ///< target of each sample in the current buffer
+    unsigned long count = 0;        ///< number of valid samples in tx, ty, and tz
+    std::uint64_t frame = ~0ull;    ///< first frame of the buffer in tx, ty, and tz
+
+    /// Jumps to a target, discarding waypoints and the path
+    void moveTo(double x, double y, double z) {
+        waypoints.clear();
+        followPath = false;
+        anchor = {target.time, x, y, z};
+        target = anchor;
+    }
+
+    /// Queues a waypoint, moving from the current target if nothing was queued
+    void addWaypoint(const Waypoint& w) {
+        if (followPath || waypoints.empty()) {
+            waypoints.clear();
+            followPath = false;
+            anchor = target;
+        }
+        if (waypoints.size() == MAX_WAYPOINTS) {
+            anchor = waypoints.front();
+            waypoints.erase(waypoints.begin());
+        }
+        auto it = std::upper_bound(waypoints.begin(), waypoints.end(), w, 
+            [](const Waypoint& a, const Waypoint& b) { return a.time < b.time; });
+        waypoints.insert(it, w);
+    }
+
+    /// Evaluates the target for each frame of a buffer (once, no matter how many channels share it)
+    void advance(std::uint64_t first, unsigned long frames, double sampleLength) {
+        if (first == frame)
+            return;
+        frame = first;
+        count = std::max(1ul, std::min(frames, MAX_FRAMES));
+        double t0 = first * sampleLength;
+        if (followPath) {
+            if (pathStart < 0)
+                pathStart = t0;
+            double t[SYNTACTS_BLOCK_SIZE];
+            for (unsigned long f0 = 0; f0 < count; f0 += SYNTACTS_BLOCK_SIZE) {
+                int n = static_cast<int>(std::min<unsigned long>(count - f0, SYNTACTS_BLOCK_SIZE));
+                for (int i = 0; i < n; ++i)
+                    t[i] = t0 + (f0 + i) * sampleLength - pathStart;
+                pathX.process(&contextX, t, &tx[f0], n);
+                pathY.process(&contextY, t, &ty[f0], n);
+                pathZ.process(&contextZ, t, &tz[f0], n);
+            }
+        }
+        else {
+            for (unsigned long f = 0; f < count; ++f) {
+                double t = t0 + f * sampleLength;
+                while (!waypoints.empty() && waypoints.front().time <= t) {
+                    anchor = waypoints.front();
+                    waypoints.erase(waypoints.begin());
+                }
+                if (waypoints.empty()) {
+                    tx[f] = anchor.x;
+                    ty[f] = anchor.y;
+                    tz[f] = anchor.z;
+                }
+                else {
+                    const auto& w = waypoints.front();
+                    double a = (t - anchor.time) / (w.time - anchor.time);
+                    tx[f] = anchor.x + (w.x - anchor.x) * a;
+                    ty[f] = anchor.y + (w.y - anchor.y) * a;
+                    tz[f] = anchor.z + (w.z - anchor.z) * a;
+                }
+            }
+        }
+        target = {t0 + (count - 1) * sampleLength, tx[count - 1], ty[count - 1], tz[count - 1]};
+    }
+
+    /// Computes the gain of a channel at (x,y,z) for n frames starting at frame f of the buffer
+    void gains(double x, double y, double z, unsigned long f, int n, double* g) const {
+        for (int i = 0; i < n; ++i) {
+            unsigned long k = std::min(f + i, count - 1);
+            double dx = x - tx[k];
+            double dy = y - ty[k];
+            double dz = z - tz[k];
+            if (wrapX > 0)
+                dx -= std::floor((dx + wrapX * 0.5) / wrapX) * wrapX;
+            if (wrapY > 0)
+                dy -= std::floor((dy + wrapY * 0.5) / wrapY) * wrapY;
+            if (wrapZ > 0)
+                dz -= std::floor((dz + wrapZ * 0.5) / wrapZ) * wrapZ;
+            double d = std::sqrt(dx * dx + dy * dy + dz * dz);
+            g[i] = rollOff(1.0 - std::min(d / radius, 1.0)) * volume;
+        }
+    }
 };
 
 /// Channel structure
 class Channel {
 public:
-    std::array<Voice,SYNTACTS_MAX_VOICES> voices;
-    Signal  signal;
+    std::vector<Voice>  voices;       ///< voice pool (twice maxVoices so stopped voices can fade out)
+    std::vector<Voice*> active;       ///< playing voices, in the order they were started
+    std::vector<Voice*> releasing;    ///< stopped or stolen voices fading out
+    std::vector<Voice*> idle;         ///< voices available to play
+    std::vector<VoiceStatus> status;  ///< published state of each voice in the pool
+    std::unique_ptr<OutputProcessor> output; ///< optional output stage (nullptr if bypassed)
+    Panner* panner = nullptr;         ///< mixer-side Spatializer positioning this channel, if any
+    double  panX         = 0.0;
+    double  panY         = 0.0;
+    double  panZ         = 0.0;
     double  sampleLength = 0.0;
     double  volume       = 1.0;
     double  pitch        = 1.0;
     double  level        = 0.0;
+    double  fadeIncr     = 1.0;       ///< per sample declick ramp increment (1 = no ramp)
+    int     maxVoices    = 0;
+    int     voiceCount   = 0;
     bool    paused       = false;
     bool    stopped      = true;
+
+    /// Allocates the voice pool (control thread only, before the stream starts)
+    void allocate(int count) {
+        maxVoices = count;
+        voices.resize(2 * count);
+        active.clear();
+        active.reserve(2 * count);
+        releasing.clear();
+        releasing.reserve(2 * count);
+        idle.clear();
+        idle.reserve(2 * count);
+        for (auto& v : voices)
+            idle.push_back(&v);
+        status = std::vector<VoiceStatus>(2 * count);
+    }
+
+    /// Publishes the id and time of each voice in the pool for Session queries
+    void publish() {
+        for (std::size_t i = 0; i < voices.size(); ++i) {
+            status[i].time.store(voices[i].time, std::memory_order_relaxed);
+            status[i].id.store(voices[i].id, std::memory_order_release);
+        }
+    }
+
+    /// Finds the active voice with an id, or returns nullptr if it has finished
+    Voice* find(std::uint32_t id) {
+        for (auto v : active) {
+            if (v->id == id)
+                return v;
+        }
+        return nullptr;
+    }
    
-    void fillBuffer(float* buffer, unsigned long frames) {
+    void fillBuffer(float* buffer, unsigned long frames, std::uint64_t frame) {
+        if (panner)
+            panner->advance(frame, frames, sampleLength);
         // interp volume
         double nextVolume = volume;
         double volumeIncr = (nextVolume - lastVolume) / frames;
@@ -68,77 +370,224 @@ public:
         double pitchIncr = (nextPitch - lastPitch) / frames;
         pitch = lastPitch;
 
-        if (paused || stopped) {
+        if ((paused || stopped) && !output) {
             for (unsigned long f = 0; f < frames; ++f) {
                 buffer[f] = 0;
                 level     = 0;
             }
         }
+        else if (paused || stopped) {
+            // keep running the output stage so its filters and look-ahead delay drain
+            double mix[SYNTACTS_BLOCK_SIZE];
+            double max_level = 0;
+            for (unsigned long f0 = 0; f0 < frames; f0 += SYNTACTS_BLOCK_SIZE) {
+                int n = static_cast<int>(std::min<unsigned long>(frames - f0, SYNTACTS_BLOCK_SIZE));
+                std::fill(mix, mix + n, 0.0);
+                output->process(mix, n);
+                for (int i = 0; i < n; ++i) {
+                    max_level = std::max(max_level, std::abs(mix[i]));
+                    buffer[f0 + i] = static_cast<float>(mix[i]);
+                }
+            }
+            level = max_level;
+        }
         else {
-            // fill buffer
+            // fill buffer in blocks, sampling only the active and releasing voices
             double max_level = 0;
-            for (unsigned long f = 0; f < frames; ++f) {
-                pitch += pitchIncr;
-                volume += volumeIncr;
-                double dt = sampleLength * pitch;
-                double output = stepVoices(dt) * volume;
-                double abs_out = std::abs(output);
-                max_level = abs_out > max_level ? abs_out : max_level;
-                buffer[f] = static_cast<float>(output);
+            double offset[SYNTACTS_BLOCK_SIZE + 1];
+            double mix[SYNTACTS_BLOCK_SIZE];
+            for (auto v : active)
+                v->level = 0;
+            for (unsigned long f0 = 0; f0 < frames; f0 += SYNTACTS_BLOCK_SIZE) {
+                int n = static_cast<int>(std::min<unsigned long>(frames - f0, SYNTACTS_BLOCK_SIZE));
+                // time offsets are shared by all voices and follow the pitch ramp
+                offset[0] = 0;
+                for (int i = 0; i < n; ++i) {
+                    pitch += pitchIncr;
+                    offset[i + 1] = offset[i] + sampleLength * pitch;
+                }
+                std::fill(mix, mix + n, 0.0);
+                for (auto v : active)
+                    render(v, offset, mix, n, f0, frames);
+                for (auto v : releasing)
+                    render(v, offset, mix, n, f0, frames);
+                for (int i = 0; i < n; ++i) {
+                    volume += volumeIncr;
+                    mix[i] *= volume;
+                }
+                if (panner) {
+                    double gain[SYNTACTS_BLOCK_SIZE];
+                    panner->gains(panX, panY, panZ, f0, n, gain);
+                    for (int i = 0; i < n; ++i)
+                        mix[i] *= gain[i];
+                }
+                if (output)
+                    output->process(mix, n);
+                for (int i = 0; i < n; ++i) {
+                    double abs_out = std::abs(mix[i]);
+                    max_level = abs_out > max_level ? abs_out : max_level;
+                    buffer[f0 + i] = static_cast<float>(mix[i]);
+                }
             }
             level = max_level; // sum_output / frames;
+            for (auto v : active)
+                v->lastVolume = v->volume;
+            for (auto v : releasing)
+                v->lastVolume = v->volume;
         }
-        stopped = activeVoices() == 0;
+        stopped = activeVoices() == 0 && releasing.empty();
+        publish();
         volume     = nextVolume;
         lastVolume = nextVolume;
         pitch      = nextPitch;
         lastPitch  = nextPitch;
     }
 
-    inline void play(Signal sig) {
-        stopped = false;
-        paused = false;
-        for (auto& v : voices) {
-            if (v.stopped) {
-                v.signal = std::move(sig);
-                v.stopped = false;
-                v.time = 0;
-                return;
+    /// Adds n samples of a voice starting at frame f0 of the buffer to mix
+    inline void render(Voice* v, const double* offset, double* mix, int n, unsigned long f0, unsigned long frames) {
+        double t[SYNTACTS_BLOCK_SIZE];
+        double s[SYNTACTS_BLOCK_SIZE];
+        for (int i = 0; i < n; ++i)
+            t[i] = v->time + offset[i] * v->pitch;
+        v->signal.process(&v->context, t, s, n);
+        // interp voice volume over the entire buffer
+        double gainIncr = (v->volume - v->lastVolume) / frames;
+        double gain = v->lastVolume + gainIncr * f0;
+        double peak = v->level;
+        if (v->fadeStep == 0) {
+            for (int i = 0; i < n; ++i) {
+                gain += gainIncr;
+                s[i] *= gain;
+                mix[i] += s[i];
+                peak = std::max(peak, std::abs(s[i]));
+            }
+        }
+        else {
+            // declick ramp, held at 0 or 1 once it completes
+            double fade = v->fade;
+            for (int i = 0; i < n; ++i) {
+                gain += gainIncr;
+                fade = clamp01(fade + v->fadeStep);
+                s[i] *= gain * fade;
+                mix[i] += s[i];
+                peak = std::max(peak, std::abs(s[i]));
             }
+            v->fade = fade;
+            if (fade == 1)
+                v->fadeStep = 0;
+        }
+        v->level = peak;
+        v->time += offset[n] * v->pitch;
+    }
+
+    inline void play(Signal& sig, Signal::Context& context, std::uint32_t id, int priority, VoiceStealing policy, double vol, double t) {
+        if (static_cast<int>(active.size()) >= maxVoices) {
+            Voice* victim = steal(priority, policy);
+            if (!victim)
+                return;
+            release(victim);
+        }
+        Voice* voice = nullptr;
+        if (!idle.empty()) {
+            voice = idle.back();
+            idle.pop_back();
         }
-        voices[0].signal  = std::move(sig);
-        voices[0].stopped = false;
-        voices[0].time    = 0;
+        else {
+            // every spare voice is still fading out, so cut the oldest short
+            voice = releasing.front();
+            releasing.erase(releasing.begin());
+        }
+        stopped = false;
+        paused = false;
+        // swap rather than assign so the voice's old Signal and state go back with the
+        // command, which the control thread destroys (see Impl::collect)
+        std::swap(voice->signal, sig);
+        std::swap(voice->context, context);
+        voice->id         = id;
+        voice->time       = t;
+        voice->level      = 0;
+        voice->volume     = vol;
+        voice->lastVolume = vol;
+        voice->pitch      = 1;
+        voice->fade       = fadeIncr < 1 ? 0 : 1;
+        voice->fadeStep   = fadeIncr < 1 ? fadeIncr : 0;
+        voice->priority   = priority;
+        active.push_back(voice);
+        voiceCount = static_cast<int>(active.size());
     }
 
     inline void stop() {
-        for (auto& v : voices) {
-            v.stopped = true;
-            v.time   = 0;
+        for (auto v : active)
+            release(v);
+        active.clear();
+        voiceCount = 0;
+    }
+
+    inline void stop(std::uint32_t id) {
+        auto it = std::find_if(active.begin(), active.end(), [id](Voice* v) { return v->id == id; });
+        if (it == active.end())
+            return;
+        release(*it);
+        active.erase(it);
+        voiceCount = static_cast<int>(active.size());
+    }
+
+    /// Fades out a voice that has been removed from active, or recycles it if it can't be heard
+    inline void release(Voice* v) {
+        v->id = 0;
+        if (paused || fadeIncr >= 1 || v->fade == 0) {
+            recycle(v);
+            return;
         }
-        paused = true;
+        v->fadeStep = -fadeIncr;
+        releasing.push_back(v);
     }
 
-    inline double stepVoices(double dt) {
-        double sum = 0;
-        for (auto& v : voices)
-            sum += v.step(dt);
-        return sum;
+    inline void recycle(Voice* v) {
+        v->id   = 0;
+        v->time = 0;
+        idle.push_back(v);
+    }
+
+    /// Removes and returns the active voice chosen by the policy, or nullptr if none may be stolen
+    inline Voice* steal(int priority, VoiceStealing policy) {
+        if (active.empty() || policy == VoiceStealing::None)
+            return nullptr;
+        auto victim = active.begin(); // oldest
+        if (policy == VoiceStealing::Quietest) {
+            victim = std::min_element(active.begin(), active.end(), [](Voice* a, Voice* b) { return a->level < b->level; });
+        }
+        else if (policy == VoiceStealing::LowestPriority) {
+            victim = std::min_element(active.begin(), active.end(), [](Voice* a, Voice* b) { return a->priority < b->priority; });
+            if ((*victim)->priority > priority)
+                return nullptr;
+        }
+        Voice* voice = *victim;
+        active.erase(victim);
+        return voice;
     }
 
     inline int activeVoices() {
-        int count = 0;
-        for (auto& v : voices) {
-            if (v.time > v.signal.length()) {
-                v.stopped = true;
-                v.time    = 0;
+        for (auto it = active.begin(); it != active.end();) {
+            if ((*it)->time > (*it)->signal.length()) {
+                recycle(*it);
+                it = active.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        for (auto it = releasing.begin(); it != releasing.end();) {
+            if ((*it)->fade == 0 || (*it)->time > (*it)->signal.length()) {
+                recycle(*it);
+                it = releasing.erase(it);
+            }
+            else {
+                ++it;
             }
         }
-        for (auto& v : voices) {
-            if (!v.stopped)
-                count++;
-        }        
-        return count;
+        voiceCount = static_cast<int>(active.size());
+        return voiceCount;
     }
 private:
     double  lastVolume   = 1.0;
@@ -152,8 +601,8 @@ struct Command {
 
     Command() { flag.test_and_set(std::memory_order_acquire); }
 
-    void perform(Channel& channel) {
-        performImpl(channel);
+    void perform(std::vector<Channel>& channels) {
+        performAll(channels);
         flag.clear(std::memory_order_release);
     }
 
@@ -162,14 +611,77 @@ struct Command {
         }
     }
 
-    virtual void performImpl(Channel& channel) = 0;
+    /// Performs the command on its channel (batched commands override this to reach several)
+    virtual void performAll(std::vector<Channel>& channels) { performImpl(channels[channel]); }
+
+    virtual void performImpl(Channel& channel) { }
 };
 
 struct Play : public Command {
     virtual void performImpl(Channel& channel) override {
-        channel.play(std::move(signal));
+        channel.play(signal, context, voice, priority, policy, volume, time);
     }
     Signal signal;
+    Signal::Context context;
+    std::uint32_t voice;
+    int priority;
+    VoiceStealing policy;
+    double volume = 1;
+    double time   = 0;
+};
+
+struct SetMaxVoices : public Command {
+    /// Prepares a new voice pool on the calling thread so the audio thread doesn't allocate
+    SetMaxVoices(int count) : maxVoices(count), voices(2 * count), status(2 * count) {
+        active.reserve(2 * count);
+        releasing.reserve(2 * count);
+        idle.reserve(2 * count);
+    }
+    virtual void performImpl(Channel& channel) override {
+        // carry over the most recently started voices that fit in the new pool (swapping,
+        // rather than assigning, so no Signals are freed on the audio thread)
+        std::size_t j = 0;
+        auto carry = [&](std::vector<Voice*>& from, std::vector<Voice*>& to, std::size_t limit) {
+            std::size_t keep = std::min(from.size(), limit);
+            for (std::size_t k = from.size() - keep; k < from.size(); ++k, ++j) {
+                std::swap(voices[j], *from[k]);
+                to.push_back(&voices[j]);
+            }
+        };
+        carry(channel.active, active, maxVoices);
+        carry(channel.releasing, releasing, voices.size() - j);
+        for (; j < voices.size(); ++j)
+            idle.push_back(&voices[j]);
+        std::swap(channel.voices, voices);
+        std::swap(channel.active, active);
+        std::swap(channel.releasing, releasing);
+        std::swap(channel.idle, idle);
+        std::swap(channel.status, status);
+        channel.maxVoices  = maxVoices;
+        channel.voiceCount = static_cast<int>(channel.active.size());
+        channel.publish();
+    }
+    int maxVoices;
+    std::vector<Voice>  voices;
+    std::vector<Voice*> active;
+    std::vector<Voice*> releasing;
+    std::vector<Voice*> idle;
+    std::vector<VoiceStatus> status;
+};
+
+struct SetOutputProcessor : public Command {
+    virtual void performImpl(Channel& channel) override {
+        // swap so the old processor is freed by the control thread
+        std::swap(channel.output, processor);
+    }
+    std::unique_ptr<OutputProcessor> processor;
+};
+
+struct SetFadeIncr : public Command {
+    virtual void performImpl(Channel& channel) override {
+        channel.fadeIncr = fadeIncr;
+    }
+    double fadeIncr;
 };
 
 struct Stop : public Command {
@@ -178,6 +690,46 @@ struct Stop : public Command {
     }
 };
 
+struct StopVoice : public Command {
+    virtual void performImpl(Channel& channel) override {
+        channel.stop(voice);
+    }
+    std::uint32_t voice;
+};
+
+struct SetVoiceVolume : public Command {
+    virtual void performImpl(Channel& channel) override {
+        if (auto v = channel.find(voice))
+            v->volume = volume;
+    }
+    std::uint32_t voice;
+    double volume;
+};
+
+struct SetVoiceVolumes : public Command {
+    virtual void performAll(std::vector<Channel>& channels) override {
+        for (auto& v : volumes) {
+            if (auto voice = channels[v.channel].find(v.id))
+                voice->volume = v.volume;
+        }
+    }
+    struct Entry {
+        int channel;
+        std::uint32_t id;
+        double volume;
+    };
+    std::vector<Entry> volumes;
+};
+
+struct SetVoicePitch : public Command {
+    virtual void performImpl(Channel& channel) override {
+        if (auto v = channel.find(voice))
+            v->pitch = pitch;
+    }
+    std::uint32_t voice;
+    double pitch;
+};
+
 struct SetPause : public Command {
     virtual void performImpl(Channel& channel) override {
         channel.paused = paused;
@@ -192,6 +744,77 @@ struct SetVolume : public Command {
     double volume;
 };
 
+struct SetVolumes : public Command {
+    virtual void performAll(std::vector<Channel>& channels) override {
+        for (auto& v : volumes)
+            channels[v.first].volume = v.second;
+    }
+    std::vector<std::pair<int,double>> volumes;
+};
+
+struct SetPanner : public Command {
+    virtual void performAll(std::vector<Channel>& channels) override {
+        for (int ch : detach) {
+            if (channels[ch].panner == panner)
+                channels[ch].panner = nullptr;
+        }
+        for (std::size_t i = 0; i < attach.size(); ++i) {
+            auto& c  = channels[attach[i]];
+            c.panner = panner;
+            c.panX   = x[i];
+            c.panY   = y[i];
+            c.panZ   = z[i];
+        }
+        panner->radius = radius;
+        panner->volume = volume;
+        panner->wrapX  = wrapX;
+        panner->wrapY  = wrapY;
+        panner->wrapZ  = wrapZ;
+        // swap so the old roll-off is freed by the control thread
+        std::swap(panner->rollOff, rollOff);
+    }
+    Panner* panner;
+    std::vector<int> detach;
+    std::vector<int> attach;
+    std::vector<double> x, y, z;
+    double radius, volume, wrapX, wrapY, wrapZ;
+    Curve rollOff;
+};
+
+struct SetPannerTarget : public Command {
+    virtual void performAll(std::vector<Channel>&) override {
+        panner->moveTo(x, y, z);
+    }
+    Panner* panner;
+    double x, y, z;
+};
+
+struct AddPannerWaypoint : public Command {
+    virtual void performAll(std::vector<Channel>&) override {
+        panner->addWaypoint(waypoint);
+    }
+    Panner* panner;
+    Panner::Waypoint waypoint;
+};
+
+struct SetPannerPath : public Command {
+    virtual void performAll(std::vector<Channel>&) override {
+        // swap so the old path is freed by the control thread
+        std::swap(panner->pathX, x);
+        std::swap(panner->pathY, y);
+        std::swap(panner->pathZ, z);
+        std::swap(panner->contextX, contextX);
+        std::swap(panner->contextY, contextY);
+        std::swap(panner->contextZ, contextZ);
+        panner->waypoints.clear();
+        panner->followPath = true;
+        panner->pathStart  = -1;
+    }
+    Panner* panner;
+    Signal x, y, z;
+    Signal::Context contextX, contextY, contextZ;
+};
+
 struct GetVolume : public Command {
     virtual void performImpl(Channel& channel) override {
         volume = channel.volume;
@@ -220,6 +843,340 @@ struct GetLevel : public Command {
     double level;
 };
 
+/// Path of the file that caches the sample rates each device supports between launches
+std::string deviceCachePath() {
+#ifdef _WIN32
+    const char* dir = std::getenv("APPDATA");
+    return dir ? std::string(dir) + "\\Syntacts\\devices.cache" : "";
+#elif __APPLE__
+    const char* dir = std::getenv("HOME");
+    return dir ? std::string(dir) + "/Library/Syntacts/devices.cache" : "";
+#elif __linux__
+    const char* dir = std::getenv("HOME");
+    return dir ? std::string(dir) + "/Syntacts/devices.cache" : "";
+#else
+    return "";
+#endif
+}
+
+/// Lock-free Histogram with a single writer (the audio thread) and any number of readers
+class Recorder {
+public:
+    Recorder() {
+        clear();
+    }
+
+    void record(std::uint64_t ns) {
+        int bin = 0;
+        for (auto us = ns / 1000; us >= 2 && bin < Histogram::Bins - 1; us >>= 1)
+            ++bin;
+        // single writer, so no read-modify-write is needed
+        m_counts[bin].store(m_counts[bin].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_total.store(m_total.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+        if (ns > m_max.load(std::memory_order_relaxed))
+            m_max.store(ns, std::memory_order_relaxed);
+        m_count.store(m_count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void clear() {
+        for (auto& c : m_counts)
+            c.store(0, std::memory_order_relaxed);
+        m_total.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+        m_count.store(0, std::memory_order_release);
+    }
+
+    Histogram snapshot() const {
+        Histogram h;
+        h.count = m_count.load(std::memory_order_acquire);
+        for (int i = 0; i < Histogram::Bins; ++i)
+            h.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        h.mean = h.count ? m_total.load(std::memory_order_relaxed) * 1e-9 / h.count : 0;
+        h.max  = m_max.load(std::memory_order_relaxed) * 1e-9;
+        return h;
+    }
+
+private:
+    std::atomic<std::uint64_t> m_counts[Histogram::Bins];
+    std::atomic<std::uint64_t> m_count;
+    std::atomic<std::uint64_t> m_total; ///< ns
+    std::atomic<std::uint64_t> m_max;   ///< ns
+};
+
+/// List of output devices shared by all Sessions. Each Session holds the registry, which initializes
+/// PortAudio when the first Session is created and terminates it when the last one is destroyed, so
+/// devices are enumerated once while any Session exists. Supported sample rates are probed on demand,
+/// one device at a time, and cached on disk keyed by API, device name, channel count, default sample
+/// rate, and PortAudio version so later launches skip probing. A device whose cached rates disagree
+/// with PortAudio when it is opened (e.g. after a driver update) is probed again.
+class DeviceRegistry {
+public:
+
+    /// Returns the registry, creating it if no Session holds it
+    static std::shared_ptr<DeviceRegistry> acquire() {
+        static std::mutex mtx;
+        static std::weak_ptr<DeviceRegistry> current;
+        std::lock_guard<std::mutex> lock(mtx);
+        auto registry = current.lock();
+        if (!registry) {
+            registry = std::shared_ptr<DeviceRegistry>(new DeviceRegistry());
+            current = registry;
+        }
+        return registry;
+    }
+
+    ~DeviceRegistry() {
+        saveCache();
+        Pa_Terminate();
+    }
+
+    /// Devices with only the sample rates that are already known (cheap)
+    const std::map<int, Device>& enumerated() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return *m_enumerated;
+    }
+
+    /// Devices with all sample rates, probing any that aren't cached the first time it's called
+    const std::map<int, Device>& probed() {
+        std::call_once(m_probedFlag, [this]() {
+            std::vector<int> indices;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                for (auto& d : *m_enumerated)
+                    indices.push_back(d.first);
+            }
+            for (int index : indices)
+                sampleRates(index);
+            {
+                // take rates from m_rates, so a reprobe made meanwhile isn't overwritten
+                std::lock_guard<std::mutex> lock(m_mtx);
+                auto devices = *m_enumerated;
+                for (auto& d : devices)
+                    d.second.sampleRates = knownRates(d.first);
+                publish(m_probed, std::move(devices));
+            }
+            saveCache();
+        });
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return *m_probed;
+    }
+
+    /// Returns the sample rates supported by a device, probing it if they aren't known
+    std::vector<int> sampleRates(int index) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        auto key = m_keys.find(index);
+        if (key == m_keys.end())
+            return {};
+        auto rates = m_rates.find(key->second);
+        if (rates != m_rates.end())
+            return rates->second;
+        auto probed = probe(index);
+        // a device that supports nothing is probably busy, so don't remember it
+        if (!probed.empty()) {
+            m_rates[key->second] = probed;
+            m_dirty = true;
+        }
+        return probed;
+    }
+
+    /// Forgets a device's cached sample rates and probes it again
+    void reprobe(int index) {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            auto key = m_keys.find(index);
+            if (key == m_keys.end())
+                return;
+            auto rates = probe(index);
+            if (rates.empty())
+                m_rates.erase(key->second);
+            else
+                m_rates[key->second] = rates;
+            m_dirty = true;
+            // devices are published as immutable snapshots, so replace them rather than edit them
+            for (auto snapshot : {&m_enumerated, &m_probed}) {
+                if (*snapshot && (*snapshot)->count(index)) {
+                    auto devices = **snapshot;
+                    devices[index].sampleRates = rates;
+                    publish(*snapshot, std::move(devices));
+                }
+            }
+        }
+        saveCache();
+    }
+
+private:
+
+    DeviceRegistry() {
+        int result = Pa_Initialize();
+        assert(result == paNoError);
+        loadCache();
+        std::map<int, Device> devices;
+        for (int i = 0; i < Pa_GetDeviceCount(); ++i) {
+            if (Pa_GetDeviceInfo(i)->maxOutputChannels > 0)
+                devices.emplace(i, makeDevice(i));
+        }
+        // clean up devices
+        correctMMENames(devices);
+        removeDigitalDevices(devices);
+        tidyNames(devices);
+        publish(m_enumerated, std::move(devices));
+    }
+
+    /// Replaces a snapshot (call with m_mtx held). Replaced snapshots are kept, since references to 
+    /// them returned by enumerated() and probed() may still be in use.
+    void publish(std::shared_ptr<const std::map<int, Device>>& snapshot, std::map<int, Device> devices) {
+        if (snapshot)
+            m_retired.push_back(std::move(snapshot));
+        snapshot = std::make_shared<const std::map<int, Device>>(std::move(devices));
+    }
+
+    /// Returns the cached sample rates of a device (call with m_mtx held)
+    std::vector<int> knownRates(int index) const {
+        auto key = m_keys.find(index);
+        if (key == m_keys.end())
+            return {};
+        auto rates = m_rates.find(key->second);
+        return rates == m_rates.end() ? std::vector<int>() : rates->second;
+    }
+
+    Device makeDevice(int index) {
+        auto pa_dev_info = Pa_GetDeviceInfo(index);
+        auto pa_api_info = Pa_GetHostApiInfo(pa_dev_info->hostApi);
+
+        Device dev;
+        dev.index = index;
+        dev.name = pa_dev_info->name;
+        dev.isDefault = index == Pa_GetDefaultOutputDevice();
+        dev.api      =   static_cast<API>(pa_api_info->type);
+        dev.apiName = pa_api_info->name;
+        dev.isApiDefault = index == Pa_GetHostApiInfo( pa_dev_info->hostApi )->defaultOutputDevice;
+        dev.maxChannels = pa_dev_info->maxOutputChannels;
+        dev.defaultSampleRate = static_cast<int>(pa_dev_info->defaultSampleRate);
+
+        // key on PortAudio's names, before they are tidied, and on what a driver change would likely alter
+        std::string key = std::string(pa_api_info->name) + "|" + pa_dev_info->name + "|" + std::to_string(dev.maxChannels) + "|" +
+                          std::to_string(dev.defaultSampleRate) + "|" + std::to_string(Pa_GetVersion());
+        auto cached = m_rates.find(key);
+        if (cached != m_rates.end())
+            dev.sampleRates = cached->second;
+        m_keys[index] = std::move(key);
+        return dev;
+    }
+
+    std::vector<int> probe(int index) const {
+        auto pa_dev_info = Pa_GetDeviceInfo(index);
+
+        std::vector<int> sampleRates;
+        sampleRates.reserve(STANDARD_SAMPLE_RATES.size());
+
+        PaStreamParameters params;
+        params.device = index;
+        params.channelCount = pa_dev_info->maxOutputChannels;
+        params.suggestedLatency = pa_dev_info->defaultLowOutputLatency;
+        params.hostApiSpecificStreamInfo = nullptr;
+        params.sampleFormat = paFloat32 | paNonInterleaved;
+
+        for (auto& s : STANDARD_SAMPLE_RATES) {
+            if (Pa_IsFormatSupported(nullptr, &params, s) == paFormatIsSupported)
+                sampleRates.push_back(static_cast<int>(s));
+        }
+        return sampleRates;
+    }
+
+    /// Reads lines of "key<TAB>rate rate ..."
+    void loadCache() {
+        std::ifstream file(deviceCachePath());
+        std::string line;
+        while (std::getline(file, line)) {
+            auto tab = line.rfind('\t');
+            if (tab == std::string::npos)
+                continue;
+            std::vector<int> rates;
+            std::istringstream ss(line.substr(tab + 1));
+            int rate;
+            while (ss >> rate)
+                rates.push_back(rate);
+            if (!rates.empty())
+                m_rates[line.substr(0, tab)] = std::move(rates);
+        }
+    }
+
+    void saveCache() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        auto path = deviceCachePath();
+        if (!m_dirty || path.empty())
+            return;
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        std::ofstream file(path);
+        if (!file)
+            return;
+        for (auto& r : m_rates) {
+            file << r.first << '\t';
+            for (auto rate : r.second)
+                file << rate << ' ';
+            file << '\n';
+        }
+        m_dirty = false;
+    }
+
+    void tidyNames(std::map<int, Device>& devices) {
+        static std::vector<std::string> apiRemoves = {"Windows "};
+        for (auto& d : devices) {
+            for (auto& r : apiRemoves) {
+                auto found = d.second.apiName.find(r);
+                if (found != std::string::npos)
+                    d.second.apiName.erase(found, r.length());
+            }
+        }
+    }
+
+    void correctMMENames(std::map<int, Device>& devices) {
+        // correct MME names
+        std::vector<std::string*> mme;
+        std::set<std::string> notMME;
+        for (auto& d : devices) {
+            if (d.second.api == API::MME)
+                mme.push_back(&d.second.name);
+            else
+                notMME.insert(d.second.name);
+        }
+        for (auto& cur : mme) {
+            for (auto& alt : notMME) {
+                if (alt.find(*cur) == 0) {
+                    *cur = alt;
+                }
+            }
+        } 
+    }
+
+    void removeDigitalDevices(std::map<int, Device>& devices) {
+        static std::vector<std::string> digitalStrings = {"SPDIF","S/PDIF","Optic","optic","digital","Digital"};
+        for (auto dev = devices.begin(); dev != devices.end();) {
+            bool remove = false;
+            for (auto& digi : digitalStrings) {
+                if (dev->second.name.find(digi) != std::string::npos) {
+                    remove = true;
+                    break;
+                }
+            }
+            if (remove)
+                devices.erase(dev++);
+            else
+                ++dev;
+        }
+    }
+
+    std::shared_ptr<const std::map<int, Device>> m_enumerated; ///< devices with known rates, replaced (never edited) under m_mtx
+    std::shared_ptr<const std::map<int, Device>> m_probed;     ///< devices with all rates, replaced (never edited) under m_mtx
+    std::vector<std::shared_ptr<const std::map<int, Device>>> m_retired; ///< replaced snapshots
+    std::once_flag m_probedFlag;
+    std::map<int, std::string> m_keys;
+    std::map<std::string, std::vector<int>> m_rates; ///< sample rates by device key
+    bool m_dirty = false;
+    std::mutex m_mtx;
+};
+
 } // private namespace
 
 Device::Device() :
@@ -239,38 +1196,23 @@ class Session::Impl {
 public:
 
     Impl() :
+        m_registry(DeviceRegistry::acquire()),
         m_stream(nullptr),
         m_commands(QUEUE_SIZE),
+        m_finished(2 * QUEUE_SIZE),
         m_device()
     {
-
-        // initialize PortAudio
-        int result = Pa_Initialize();
-        assert(result == paNoError);
-        // build list of available devices
-        for (int i = 0; i < Pa_GetDeviceCount(); ++i) {
-            if (Pa_GetDeviceInfo(i)->maxOutputChannels > 0) {   
-                m_devices.emplace(i, makeDevice(i));
-            }   
-        }
-        // clean up devices
-        correctMMENames();
-        removeDigitalDevices();
-        tidyNames();
         s_count++;
     }
 
     ~Impl() {
-        if (isOpen())
-            close();
-        int result = Pa_Terminate();
-        assert(result == paNoError);
+        close();
         s_count--;
     }
 
     std::vector<int> channelNumbers;
 
-    int open(const Device& device, int channels, double sampleRate) {
+    int open(const Device& device, int channels, double sampleRate, int framesPerBuffer = FRAMES_PER_BUFFER, double latency = 0) {
 
         // return if already open
         if (isOpen())
@@ -289,23 +1231,32 @@ public:
         PaStreamParameters params;
         params.device = device.index;
         params.channelCount = channels;
-        params.suggestedLatency = Pa_GetDeviceInfo(params.device)->defaultLowOutputLatency;
+        params.suggestedLatency = latency > 0 ? latency : Pa_GetDeviceInfo(params.device)->defaultLowOutputLatency;
         params.hostApiSpecificStreamInfo = nullptr;
         params.sampleFormat = paFloat32 | paNonInterleaved;
 
         sampleRate = sampleRate == 0 ? device.defaultSampleRate : sampleRate;
 
-        if (Pa_IsFormatSupported(nullptr, &params, sampleRate) != paFormatIsSupported)
+        bool supported = Pa_IsFormatSupported(nullptr, &params, sampleRate) == paFormatIsSupported;
+        // cached rates that disagree with PortAudio are stale (e.g. the driver changed), so probe again
+        bool standard = std::find(STANDARD_SAMPLE_RATES.begin(), STANDARD_SAMPLE_RATES.end(), sampleRate) != STANDARD_SAMPLE_RATES.end();
+        bool cached = std::find(device.sampleRates.begin(), device.sampleRates.end(), static_cast<int>(sampleRate)) != device.sampleRates.end();
+        bool stale = standard && !device.sampleRates.empty() && supported != cached;
+        if (stale)
+            m_registry->reprobe(device.index);
+
+        if (!supported)
             return SyntactsError_InvalidSampleRate;
 
-        // resize vector of channels
-        m_channels.clear();
-        m_channels.resize(channels);
-        for (auto& c : m_channels) 
-            c.sampleLength = 1.0 / sampleRate;
+        // probe rates before the device is in use (no-op if they are cached)
+        if (device.sampleRates.empty())
+            m_registry->sampleRates(device.index);
+
+        allocateChannels(channels, sampleRate);
         // open stream
         int result;
-        result = Pa_OpenStream(&m_stream, nullptr, &params, sampleRate, FRAMES_PER_BUFFER, paNoFlag, callback, this);
+        framesPerBuffer = framesPerBuffer > 0 ? framesPerBuffer : paFramesPerBufferUnspecified;
+        result = Pa_OpenStream(&m_stream, nullptr, &params, sampleRate, framesPerBuffer, paNoFlag, callback, this);
         if (result != paNoError)
             return result;  
         result = Pa_StartStream(m_stream);
@@ -313,25 +1264,208 @@ public:
             return result;
         // set device/sampel rate
         m_device = device;
+        if (m_device.sampleRates.empty() || stale)
+            m_device.sampleRates = m_registry->sampleRates(device.index);
         m_sampleRate = sampleRate;
         return SyntactsError_NoError;
     }
 
-    int close() {
-        if (!isOpen())
+    int openOffline(int channels, double sampleRate) {
+        if (isOpen())
+            return SyntactsError_AlreadyOpen;
+        if (channels <= 0)
+            return SyntactsError_InvalidChannel;
+        if (!(sampleRate > 0))
+            return SyntactsError_InvalidSampleRate;
+        channelNumbers.resize(channels);
+        std::iota(channelNumbers.begin(), channelNumbers.end(), 1);
+        allocateChannels(channels, sampleRate);
+        m_device = Device();
+        m_device.name = "Offline";
+        m_device.apiName = "Offline";
+        m_device.maxChannels = channels;
+        m_device.sampleRates = {static_cast<int>(sampleRate)};
+        m_device.defaultSampleRate = static_cast<int>(sampleRate);
+        m_sampleRate = sampleRate;
+        m_offline = true;
+        return SyntactsError_NoError;
+    }
+
+    int renderOffline(float** buffers, int frames) {
+        if (!m_offline)
             return SyntactsError_NotOpen;
-        int result = Pa_CloseStream(m_stream);
-        if (result != paNoError) {
-            return result;
+        if (frames > 0)
+            render(buffers, static_cast<unsigned long>(frames));
+        return SyntactsError_NoError;
+    }
+
+    /// Resizes the vector of channels
+    void allocateChannels(int channels, double sampleRate) {
+        m_channelStats = std::make_unique<Recorder[]>(channels);
+        clearStats();
+        m_openTime = std::chrono::steady_clock::now();
+        m_channels.clear();
+        m_channels.resize(channels);
+        m_stages.assign(channels, OutputStage());
+        m_panners.clear();
+        m_frame = 0;
+        m_time  = 0;
+        for (auto& c : m_channels) {
+            c.sampleLength = 1.0 / sampleRate;
+            c.allocate(m_maxVoices);
+            c.fadeIncr = fadeIncrement(sampleRate);
+        }
+    }
+
+#ifdef SYNTACTS_USE_JACK
+
+    int openJack(int channels, const std::string& clientName, bool connect) {
+        if (isOpen())
+            return SyntactsError_AlreadyOpen;
+        jack_status_t status;
+        m_jack = jack_client_open(clientName.c_str(), JackNoStartServer, &status);
+        if (!m_jack)
+            return SyntactsError_InvalidDevice;
+        // default to one channel per physical playback port
+        const char** physical = jack_get_ports(m_jack, nullptr, JACK_DEFAULT_AUDIO_TYPE, JackPortIsPhysical | JackPortIsInput);
+        int physicalCount = 0;
+        while (physical && physical[physicalCount])
+            ++physicalCount;
+        if (channels <= 0)
+            channels = physicalCount;
+        if (channels <= 0) {
+            jack_free(physical);
+            closeJack();
+            return SyntactsError_InvalidChannel;
+        }
+        channelNumbers.resize(channels);
+        std::iota(channelNumbers.begin(), channelNumbers.end(), 1);
+        m_sampleRate = jack_get_sample_rate(m_jack);
+        allocateChannels(channels, m_sampleRate);
+        m_jackPorts.resize(channels);
+        m_jackBuffers.resize(channels);
+        for (int i = 0; i < channels; ++i) {
+            auto name = "out_" + std::to_string(i + 1);
+            m_jackPorts[i] = jack_port_register(m_jack, name.c_str(), JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput | JackPortIsTerminal, 0);
+            if (!m_jackPorts[i]) {
+                jack_free(physical);
+                closeJack();
+                return SyntactsError_InvalidChannel;
+            }
+        }
+        m_jackShutdown = false;
+        jack_set_process_callback(m_jack, jackProcess, this);
+        jack_set_xrun_callback(m_jack, jackXrun, this);
+        jack_set_buffer_size_callback(m_jack, jackBufferSize, this);
+        jack_set_thread_init_callback(m_jack, jackThreadInit, this);
+        jack_on_shutdown(m_jack, jackShutdown, this);
+        m_framesPerBuffer = jack_get_buffer_size(m_jack);
+        if (jack_activate(m_jack) != 0) {
+            jack_free(physical);
+            closeJack();
+            return SyntactsError_InvalidDevice;
+        }
+        // ports can only be connected once the client is active
+        if (connect) {
+            for (int i = 0; i < channels && i < physicalCount; ++i)
+                jack_connect(m_jack, jack_port_name(m_jackPorts[i]), physical[i]);
+        }
+        jack_free(physical);
+        m_device = Device();
+        m_device.name = jack_get_client_name(m_jack);
+        m_device.api = API::JACK;
+        m_device.apiName = "JACK";
+        m_device.maxChannels = channels;
+        m_device.sampleRates = {static_cast<int>(m_sampleRate)};
+        m_device.defaultSampleRate = static_cast<int>(m_sampleRate);
+        return SyntactsError_NoError;
+    }
+
+    void closeJack() {
+        jack_deactivate(m_jack);
+        jack_client_close(m_jack);
+        m_jack = nullptr;
+        m_jackPorts.clear();
+        m_jackBuffers.clear();
+    }
+
+    /// Renders directly into the JACK port buffers
+    static int jackProcess(jack_nframes_t frames, void* arg) {
+        auto session = static_cast<Session::Impl*>(arg);
+        for (std::size_t c = 0; c < session->m_jackPorts.size(); ++c)
+            session->m_jackBuffers[c] = static_cast<float*>(jack_port_get_buffer(session->m_jackPorts[c], frames));
+        session->render(session->m_jackBuffers.data(), frames);
+        return 0;
+    }
+
+    static int jackXrun(void* arg) {
+        static_cast<Session::Impl*>(arg)->recordXrun();
+        return 0;
+    }
+
+    static int jackBufferSize(jack_nframes_t frames, void* arg) {
+        // buffers of any size are rendered in blocks, so only the size needs to be known
+        static_cast<Session::Impl*>(arg)->m_framesPerBuffer = frames;
+        return 0;
+    }
+
+    static void jackThreadInit(void* arg) {
+        // a real-time server should have made the process thread real-time, but some (e.g. sandboxed
+        // PipeWire clients) don't, so request the server's priority if it's missing
+        auto session = static_cast<Session::Impl*>(arg);
+        int policy;
+        sched_param param;
+        if (!jack_is_realtime(session->m_jack) || pthread_getschedparam(pthread_self(), &policy, &param) != 0)
+            return;
+        int priority = jack_client_real_time_priority(session->m_jack);
+        if (policy == SCHED_OTHER && priority > 0)
+            jack_acquire_real_time_scheduling(pthread_self(), priority);
+    }
+
+    static void jackShutdown(void* arg) {
+        static_cast<Session::Impl*>(arg)->m_jackShutdown = true;
+    }
+
+#endif
+
+    int close() {
+        if (m_offline)
+            m_offline = false;
+        else
+#ifdef SYNTACTS_USE_JACK
+        // the client must be closed even if the server shut it down
+        if (m_jack)
+            closeJack();
+        else
+#endif
+        {
+            if (!isOpen())
+                return SyntactsError_NotOpen;
+            int result = Pa_CloseStream(m_stream);
+            if (result != paNoError) {
+                return result;
+            }
         }
+        // the audio thread is gone, so drop anything it didn't get to
+        while (m_commands.front())
+            m_commands.pop();
+        collect();
         m_device = Device();
         m_channels.clear();
+        m_stages.clear();
+        m_panners.clear();
         m_sampleRate = 0;
         m_stream = nullptr;
         return SyntactsError_NoError;
     }
 
     bool isOpen() const {
+        if (m_offline)
+            return true;
+#ifdef SYNTACTS_USE_JACK
+        if (m_jack)
+            return !m_jackShutdown;
+#endif
         return m_stream != nullptr && Pa_IsStreamActive(m_stream) == 1;
     }
 
@@ -343,19 +1477,119 @@ public:
         return m_channels[channel].paused; 
     }
 
-    int play(int channel, Signal signal) {
+    VoiceId play(int channel, Signal signal, int priority, double volume = 1, double time = 0) {
+        VoiceId voice;
+        voice.channel = channel;
+        if (!isOpen()) {
+            voice.error = SyntactsError_NotOpen;
+            return voice;
+        }
+        if (!(channel < m_channels.size())) {
+            voice.error = SyntactsError_InvalidChannel;
+            return voice;
+        }
+        // ids are generation counted so a stale VoiceId never refers to a later Signal
+        voice.id = ++m_voiceCounter;
+        if (voice.id == 0)
+            voice.id = ++m_voiceCounter;
+        auto command = std::make_shared<Play>();
+        command->signal = std::move(signal);
+        command->signal.prepare(command->context);
+        command->channel = channel;
+        command->voice = voice.id;
+        command->priority = priority;
+        command->policy = m_stealing;
+        command->volume = clamp01(volume);
+        command->time = std::max(0.0, time);
+        bool success = push(std::move(command));
+        assert(success);
+        return voice;
+    }
+
+    /// Returns the published status of a voice, or nullptr if it isn't playing
+    const VoiceStatus* findVoice(const VoiceId& voice) const {
+        if (!isOpen() || voice.error != SyntactsError_NoError || voice.id == 0)
+            return nullptr;
+        if (!(voice.channel >= 0 && voice.channel < m_channels.size()))
+            return nullptr;
+        for (auto& status : m_channels[voice.channel].status) {
+            if (status.id.load(std::memory_order_acquire) == voice.id)
+                return &status;
+        }
+        return nullptr;
+    }
+
+    int checkVoice(const VoiceId& voice) const {
+        if (!isOpen())
+            return SyntactsError_NotOpen;
+        if (!(voice.channel >= 0 && voice.channel < m_channels.size()))
+            return SyntactsError_InvalidChannel;
+        if (voice.error != SyntactsError_NoError || voice.id == 0)
+            return SyntactsError_InvalidVoice;
+        return SyntactsError_NoError;
+    }
+
+    int stop(const VoiceId& voice) {
+        if (int ret = checkVoice(voice))
+            return ret;
+        auto command = std::make_shared<StopVoice>();
+        command->channel = voice.channel;
+        command->voice   = voice.id;
+        bool success = push(std::move(command));
+        assert(success);
+        return SyntactsError_NoError;
+    }
+
+    int setVolume(const VoiceId& voice, double volume) {
+        if (int ret = checkVoice(voice))
+            return ret;
+        auto command = std::make_shared<SetVoiceVolume>();
+        command->channel = voice.channel;
+        command->voice   = voice.id;
+        command->volume  = clamp01(volume);
+        bool success = push(std::move(command));
+        assert(success);
+        return SyntactsError_NoError;
+    }
+
+    int setVolumes(const std::vector<VoiceId>& voices, const std::vector<double>& volumes) {
         if (!isOpen())
             return SyntactsError_NotOpen;
-        if (!(channel < m_channels.size()))
-            return SyntactsError_InvalidChannel;
-        auto command = std::make_shared<Play>();
-        command->signal = std::move(signal);
-        command->channel = channel;
-        bool success = m_commands.try_push(std::move(command));
+        if (voices.size() != volumes.size())
+            return SyntactsError_InvalidVoiceCount;
+        auto command = std::make_shared<SetVoiceVolumes>();
+        command->volumes.reserve(voices.size());
+        for (std::size_t i = 0; i < voices.size(); ++i) {
+            if (int ret = checkVoice(voices[i]))
+                return ret;
+            command->volumes.push_back({voices[i].channel, voices[i].id, clamp01(volumes[i])});
+        }
+        bool success = push(std::move(command));
+        assert(success);
+        return SyntactsError_NoError;
+    }
+
+    int setPitch(const VoiceId& voice, double pitch) {
+        if (int ret = checkVoice(voice))
+            return ret;
+        auto command = std::make_shared<SetVoicePitch>();
+        command->channel = voice.channel;
+        command->voice   = voice.id;
+        command->pitch   = pitch;
+        bool success = push(std::move(command));
         assert(success);
         return SyntactsError_NoError;
     }
 
+    bool isPlaying(const VoiceId& voice) {
+        return findVoice(voice) != nullptr;
+    }
+
+    double getTime(const VoiceId& voice) {
+        auto status = findVoice(voice);
+        return status ? status->time.load(std::memory_order_relaxed) : 0;
+    }
+
     int stop(int channel) {
         if (!isOpen())
             return SyntactsError_NotOpen;
@@ -363,7 +1597,7 @@ public:
             return SyntactsError_InvalidChannel;
         auto command = std::make_shared<Stop>();
         command->channel = channel;   
-        bool success = m_commands.try_push(std::move(command));
+        bool success = push(std::move(command));
         assert(success);
         return SyntactsError_NoError;     
     }
@@ -376,7 +1610,7 @@ public:
         auto command = std::make_shared<SetPause>();
         command->channel = channel;   
         command->paused  = paused;
-        bool success = m_commands.try_push(std::move(command));
+        bool success = push(std::move(command));
         assert(success);
         return SyntactsError_NoError;       
     }
@@ -386,11 +1620,135 @@ public:
         auto command = std::make_shared<SetVolume>();
         command->channel = channel;
         command->volume  = clamp01(volume);
-        bool success = m_commands.try_push(std::move(command));
+        bool success = push(std::move(command));
         assert(success);
         return SyntactsError_NoError; 
     }
 
+    int setVolumes(const std::vector<int>& channels, const std::vector<double>& volumes) {
+        if (!isOpen())
+            return SyntactsError_NotOpen;
+        if (channels.size() != volumes.size())
+            return SyntactsError_InvalidChannelCount;
+        auto command = std::make_shared<SetVolumes>();
+        command->volumes.reserve(channels.size());
+        for (std::size_t i = 0; i < channels.size(); ++i) {
+            if (!(channels[i] >= 0 && channels[i] < m_channels.size()))
+                return SyntactsError_InvalidChannel;
+            command->volumes.emplace_back(channels[i], clamp01(volumes[i]));
+        }
+        bool success = push(std::move(command));
+        assert(success);
+        return SyntactsError_NoError;
+    }
+
+    int setPanner(const void* owner, const std::vector<int>& channels, const std::vector<double>& x, const std::vector<double>& y, 
+                  const std::vector<double>& z, double radius, Curve rollOff, double wrapX, double wrapY, double wrapZ, double volume, 
+                  double targetX, double targetY, double targetZ) 
+    {
+        if (!isOpen())
+            return SyntactsError_NotOpen;
+        for (auto& ch : channels) {
+            if (!(ch >= 0 && ch < m_channels.size()))
+                return SyntactsError_InvalidChannel;
+        }
+        auto& panner = m_panners[owner];
+        if (!panner) {
+            panner = std::make_unique<Panner>();
+            panner->target = {getTime(), targetX, targetY, targetZ};
+            panner->anchor = panner->target;
+        }
+        auto command = std::make_shared<SetPanner>();
+        command->panner  = panner.get();
+        command->detach  = std::move(panner->channels);
+        command->attach  = channels;
+        command->x       = x;
+        command->y       = y;
+        command->z       = z;
+        command->radius  = radius;
+        command->volume  = volume;
+        command->wrapX   = wrapX;
+        command->wrapY   = wrapY;
+        command->wrapZ   = wrapZ;
+        command->rollOff = std::move(rollOff);
+        panner->channels = channels;
+        bool success = push(command);
+        assert(success);
+        waitFor(command);
+        return SyntactsError_NoError;
+    }
+
+    int removePanner(const void* owner) {
+        auto it = m_panners.find(owner);
+        if (it == m_panners.end())
+            return SyntactsError_NoError;
+        if (isOpen()) {
+            // detach its channels before the audio thread lets go of it
+            auto command = std::make_shared<SetPanner>();
+            command->panner  = it->second.get();
+            command->detach  = it->second->channels;
+            command->radius  = it->second->radius;
+            command->volume  = it->second->volume;
+            command->wrapX   = it->second->wrapX;
+            command->wrapY   = it->second->wrapY;
+            command->wrapZ   = it->second->wrapZ;
+            command->rollOff = it->second->rollOff;
+            bool success = push(command);
+            assert(success);
+            waitFor(command);
+        }
+        m_panners.erase(it);
+        return SyntactsError_NoError;
+    }
+
+    int setPannerTarget(const void* owner, double x, double y, double z) {
+        auto it = m_panners.find(owner);
+        if (!isOpen() || it == m_panners.end())
+            return SyntactsError_NotOpen;
+        auto command = std::make_shared<SetPannerTarget>();
+        command->panner = it->second.get();
+        command->x = x;
+        command->y = y;
+        command->z = z;
+        bool success = push(std::move(command));
+        assert(success);
+        return SyntactsError_NoError;
+    }
+
+    int addPannerWaypoint(const void* owner, double time, double x, double y, double z) {
+        auto it = m_panners.find(owner);
+        if (!isOpen() || it == m_panners.end())
+            return SyntactsError_NotOpen;
+        auto command = std::make_shared<AddPannerWaypoint>();
+        command->panner   = it->second.get();
+        command->waypoint = {time, x, y, z};
+        bool success = push(std::move(command));
+        assert(success);
+        return SyntactsError_NoError;
+    }
+
+    int setPannerPath(const void* owner, Signal x, Signal y, Signal z) {
+        auto it = m_panners.find(owner);
+        if (!isOpen() || it == m_panners.end())
+            return SyntactsError_NotOpen;
+        auto command = std::make_shared<SetPannerPath>();
+        command->panner = it->second.get();
+        command->x = std::move(x);
+        command->y = std::move(y);
+        command->z = std::move(z);
+        command->x.prepare(command->contextX);
+        command->y.prepare(command->contextY);
+        command->z.prepare(command->contextZ);
+        bool success = push(command);
+        assert(success);
+        waitFor(command);
+        return SyntactsError_NoError;
+    }
+
+    double getTime() const {
+        return isOpen() ? m_time.load(std::memory_order_relaxed) : 0;
+    }
+
     double getVolume(int channel) {
         if (!isOpen())
             return 0;
@@ -400,7 +1758,7 @@ public:
             return m_channels[channel].volume; // this *should* be thread safe, TBD
         else {
             auto command = std::make_shared<GetVolume>();
-            bool success = m_commands.try_push(std::move(command));
+            bool success = push(std::move(command));
             assert(success);
             return command->volume;
         } 
@@ -414,7 +1772,7 @@ public:
         auto command = std::make_shared<SetPitch>();
         command->channel = channel;
         command->pitch   = pitch;
-        bool success = m_commands.try_push(std::move(command));
+        bool success = push(std::move(command));
         assert(success);
         return SyntactsError_NoError;       
     }
@@ -428,7 +1786,7 @@ public:
             return m_channels[channel].pitch;
         else {
             auto command = std::make_shared<GetPitch>();
-            bool success = m_commands.try_push(std::move(command));
+            bool success = push(std::move(command));
             assert(success);
             return command->pitch;
         } 
@@ -443,27 +1801,137 @@ public:
             return m_channels[channel].level;
         else {        
             auto command = std::make_shared<GetLevel>();
-            bool success = m_commands.try_push(std::move(command));
+            bool success = push(std::move(command));
             assert(success);
             return command->level;
         }
     }
 
+    int setMaxVoices(int voices) {
+        if (voices < 1)
+            return SyntactsError_InvalidVoiceCount;
+        m_maxVoices = voices;
+        if (!isOpen())
+            return SyntactsError_NoError;
+        std::vector<std::shared_ptr<SetMaxVoices>> commands;
+        for (int c = 0; c < (int)m_channels.size(); ++c) {
+            auto command = std::make_shared<SetMaxVoices>(voices);
+            command->channel = c;
+            commands.push_back(command);
+            bool success = push(std::move(command));
+            assert(success);
+        }
+        // wait for the swap so the old pools are freed here and not on the audio thread
+        for (auto& command : commands) 
+            waitFor(command);
+        return SyntactsError_NoError;
+    }
+
+    int setOutputStage(int channel, const OutputStage& stage) {
+        if (!isOpen())
+            return SyntactsError_NotOpen;
+        if (!(channel < m_channels.size()))
+            return SyntactsError_InvalidChannel;
+        auto command = std::make_shared<SetOutputProcessor>();
+        command->channel = channel;
+        if (stage.dcBlocker || stage.eq || stage.limiter || stage.softClip)
+            command->processor = std::make_unique<OutputProcessor>(stage, m_sampleRate);
+        bool success = push(command);
+        assert(success);
+        waitFor(command);
+        m_stages[channel] = stage;
+        return SyntactsError_NoError;
+    }
+
+    const OutputStage& getOutputStage(int channel) const {
+        static OutputStage bypass;
+        if (!(channel < m_stages.size()))
+            return bypass;
+        return m_stages[channel];
+    }
+
+    /// Waits until the audio thread has performed and released a command, so anything it holds is freed on this thread
+    template <typename C>
+    void waitFor(const std::shared_ptr<C>& command) {
+        // offline there is no audio thread, so perform the command here
+        if (m_offline)
+            performCommands();
+        command->wait();
+        while (command.use_count() > 1) {
+            collect();
+            std::this_thread::yield();
+        }
+    }
+
+    /// Queues a command for the audio thread, first destroying commands it has finished
+    bool push(std::shared_ptr<Command> command) {
+        collect();
+        return m_commands.try_push(std::move(command));
+    }
+
+    /// Destroys commands the audio thread has performed. Commands own whatever they swapped out
+    /// of the mixer (old Signals, contexts, processors), so this is where those are freed.
+    void collect() {
+        while (m_finished.front())
+            m_finished.pop();
+    }
+
+    int setFadeTime(double seconds) {
+        m_fadeTime = std::max(0.0, seconds);
+        if (!isOpen())
+            return SyntactsError_NoError;
+        for (int c = 0; c < (int)m_channels.size(); ++c) {
+            auto command = std::make_shared<SetFadeIncr>();
+            command->channel  = c;
+            command->fadeIncr = fadeIncrement(m_sampleRate);
+            bool success = push(std::move(command));
+            assert(success);
+        }
+        return SyntactsError_NoError;
+    }
+
+    /// Returns the per sample declick ramp increment for the current fade time
+    double fadeIncrement(double sampleRate) const {
+        double samples = m_fadeTime * sampleRate;
+        return samples > 1 ? 1.0 / samples : 1.0;
+    }
+
+    int getMaxVoices() const {
+        return m_maxVoices;
+    }
+
+    int getVoiceCount(int channel) {
+        if (!isOpen())
+            return 0;
+        if (!(channel < m_channels.size()))
+            return 0;
+        return m_channels[channel].voiceCount;
+    }
+
     const Device& getCurrentDevice() const {
         return m_device;
     }
 
     const Device& getDefaultDevice() const {
-        int def = Pa_GetDefaultOutputDevice();
-        assert(def != paNoDevice);
-        if (m_devices.count(def))
-            return m_devices.at(def);
-        else
-            return m_devices.begin()->second;
+        return defaultDevice(getAvailableDevices());
     }
 
     const std::map<int, Device>& getAvailableDevices() const {
-        return m_devices;
+        return m_registry->probed();
+    }
+
+    /// Devices without probing sample rates, for opening by index, name, or API
+    const std::map<int, Device>& getEnumeratedDevices() const {
+        return m_registry->enumerated();
+    }
+
+    static const Device& defaultDevice(const std::map<int, Device>& devices) {
+        int def = Pa_GetDefaultOutputDevice();
+        assert(def != paNoDevice);
+        if (devices.count(def))
+            return devices.at(def);
+        else
+            return devices.begin()->second;
     }
 
     int getChannelCount() const {
@@ -478,19 +1946,43 @@ public:
     }
 
     double getCpuLoad() const {
-        if (isOpen())
+#ifdef SYNTACTS_USE_JACK
+        if (m_jack)
+            return isOpen() ? jack_cpu_load(m_jack) / 100 : 0;
+#endif
+        if (isOpen() && m_stream)
             return Pa_GetStreamCpuLoad(m_stream);
         return 0;
     }
 
+    double getLatency() const {
+#ifdef SYNTACTS_USE_JACK
+        if (m_jack) {
+            if (!isOpen() || m_jackPorts.empty())
+                return 0;
+            jack_latency_range_t range;
+            jack_port_get_latency_range(m_jackPorts[0], JackPlaybackLatency, &range);
+            return (range.max + m_framesPerBuffer) / m_sampleRate;
+        }
+#endif
+        if (isOpen() && m_stream) {
+            auto info = Pa_GetStreamInfo(m_stream);
+            return info ? info->outputLatency : 0;
+        }
+        return 0;
+    }
+
     static int count() {
         return s_count;
     }
 
     void performCommands() {
-        while (m_commands.front()) {
-            auto command = *m_commands.front();
-            command->perform(m_channels[command->channel]);
+        // performed commands are handed back to the control thread to be destroyed; if it has
+        // fallen behind, leave the rest queued until the next buffer rather than free them here
+        while (m_commands.front() && m_finished.size() + 1 < m_finished.capacity()) {
+            auto& command = *m_commands.front();
+            command->perform(m_channels);
+            m_finished.push(std::move(command));
             m_commands.pop();
         }
     }
@@ -502,111 +1994,121 @@ public:
                  void *userData)
     {
         Session::Impl* session = (Session::Impl*)userData;
-        auto& channels = session->m_channels;
-        session->performCommands();
         (void)inputBuffer;     
-        float** out = (float**)outputBuffer;
-        for (std::size_t c = 0; c < channels.size(); ++c) {
-            channels[c].fillBuffer(out[c], framesPerBuffer);
-        }
+        if (statusFlags & (paOutputUnderflow | paOutputOverflow))
+            session->recordXrun();
+        session->render((float**)outputBuffer, framesPerBuffer);
         return paContinue;
     }
 
-    void openControlPanel(int index) {
-#if PA_USE_ASIO
-        PaAsio_ShowControlPanel(index, nullptr);
-#endif
+    /// Performs pending commands and fills one non-interleaved buffer per channel
+    void render(float** out, unsigned long frames) {
+        using Clock = std::chrono::steady_clock;
+        auto start = Clock::now();
+        if (m_resetStats.exchange(false, std::memory_order_acquire))
+            clearStats();
+        int depth = static_cast<int>(m_commands.size());
+        m_queueDepth.store(depth, std::memory_order_relaxed);
+        if (depth > m_queueDepthMax.load(std::memory_order_relaxed))
+            m_queueDepthMax.store(depth, std::memory_order_relaxed);
+        performCommands();
+        auto last = Clock::now();
+        for (std::size_t c = 0; c < m_channels.size(); ++c) {
+            m_channels[c].fillBuffer(out[c], frames, m_frame);
+            auto now = Clock::now();
+            m_channelStats[c].record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count());
+            last = now;
+        }
+        m_callbackStats.record(std::chrono::duration_cast<std::chrono::nanoseconds>(last - start).count());
+        m_lastFrames.store(frames, std::memory_order_relaxed);
+        m_frame += frames;
+        m_time.store(m_frame / m_sampleRate, std::memory_order_relaxed);
     }
 
-    Device makeDevice(int index) const {
-        auto pa_dev_info = Pa_GetDeviceInfo(index);
-        auto pa_api_info = Pa_GetHostApiInfo(pa_dev_info->hostApi);
-
-        std::vector<int> sampleRates;
-        sampleRates.reserve(STANDARD_SAMPLE_RATES.size());
-
-        PaStreamParameters params;
-        params.device = index;
-        params.channelCount = pa_dev_info->maxOutputChannels;
-        params.suggestedLatency = Pa_GetDeviceInfo(params.device)->defaultLowOutputLatency;
-        params.hostApiSpecificStreamInfo = nullptr;
-        params.sampleFormat = paFloat32 | paNonInterleaved;
-
-
-        for (auto& s : STANDARD_SAMPLE_RATES) {
-            if (Pa_IsFormatSupported(nullptr, &params, s) == paFormatIsSupported)
-                sampleRates.push_back(static_cast<int>(s));
-        }
+    void recordXrun() {
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_openTime).count();
+        auto n = m_xruns.load(std::memory_order_relaxed);
+        m_xrunTimes[n % m_xrunTimes.size()].store(t, std::memory_order_relaxed);
+        m_xruns.store(n + 1, std::memory_order_release);
+    }
 
-        Device dev;
-        dev.index = index;
-        dev.name = pa_dev_info->name;
-        dev.isDefault = index == Pa_GetDefaultOutputDevice();
-        dev.api      =   static_cast<API>(pa_api_info->type);
-        dev.apiName = pa_api_info->name;
-        dev.isApiDefault = index == Pa_GetHostApiInfo( pa_dev_info->hostApi )->defaultOutputDevice;
-        dev.maxChannels = pa_dev_info->maxOutputChannels;
-        dev.sampleRates = std::move(sampleRates);
-        dev.defaultSampleRate = static_cast<int>(pa_dev_info->defaultSampleRate);
-        return dev;
+    /// Clears stats, only called by the audio thread or when it isn't running
+    void clearStats() {
+        m_callbackStats.clear();
+        for (std::size_t c = 0; m_channelStats && c < m_channels.size(); ++c)
+            m_channelStats[c].clear();
+        m_queueDepth.store(0, std::memory_order_relaxed);
+        m_queueDepthMax.store(0, std::memory_order_relaxed);
+        m_xruns.store(0, std::memory_order_release);
     }
 
-    void tidyNames() {
-        static std::vector<std::string> apiRemoves = {"Windows "};
-        for (auto& d : m_devices) {
-            for (auto& r : apiRemoves) {
-                auto found = d.second.apiName.find(r);
-                if (found != std::string::npos)
-                    d.second.apiName.erase(found, r.length());
-            }
-        }
+    SessionStats getStats() const {
+        SessionStats stats;
+        if (!m_channelStats)
+            return stats;
+        stats.callback = m_callbackStats.snapshot();
+        for (std::size_t c = 0; c < m_channels.size(); ++c)
+            stats.channels.push_back(m_channelStats[c].snapshot());
+        stats.budget = m_sampleRate > 0 ? m_lastFrames.load(std::memory_order_relaxed) / m_sampleRate : 0;
+        stats.queueDepth = m_queueDepth.load(std::memory_order_relaxed);
+        stats.queueDepthMax = m_queueDepthMax.load(std::memory_order_relaxed);
+        stats.xruns = m_xruns.load(std::memory_order_acquire);
+        auto kept = std::min<std::uint64_t>(stats.xruns, m_xrunTimes.size());
+        for (auto i = stats.xruns - kept; i < stats.xruns; ++i)
+            stats.xrunTimes.push_back(m_xrunTimes[i % m_xrunTimes.size()].load(std::memory_order_relaxed));
+        return stats;
     }
 
-    void correctMMENames() {
-        // correct MME names
-        std::vector<std::string*> mme;
-        std::set<std::string> notMME;
-        for (auto& d : m_devices) {
-            if (d.second.api == API::MME)
-                mme.push_back(&d.second.name);
-            else
-                notMME.insert(d.second.name);
-        }
-        for (auto& cur : mme) {
-            for (auto& alt : notMME) {
-                if (alt.find(*cur) == 0) {
-                    *cur = alt;
-                }
-            }
-        } 
+    void resetStats() {
+        if (isOpen())
+            m_resetStats.store(true, std::memory_order_release);
+        else
+            clearStats();
     }
 
-    void removeDigitalDevices() {
-        static std::vector<std::string> digitalStrings = {"SPDIF","S/PDIF","Optic","optic","digital","Digital"};
-        for (auto dev = m_devices.begin(); dev != m_devices.end();) {
-            bool remove = false;
-            for (auto& digi : digitalStrings) {
-                if (dev->second.name.find(digi) != std::string::npos) {
-                    remove = true;
-                    break;
-                }
-            }
-            if (remove)
-                m_devices.erase(dev++);
-            else
-                ++dev;
-        }
+    void openControlPanel(int index) {
+#if PA_USE_ASIO
+        PaAsio_ShowControlPanel(index, nullptr);
+#endif
     }
 
+    std::shared_ptr<DeviceRegistry> m_registry; ///< keeps PortAudio initialized while the Session exists
     Device m_device;
-    std::map<int, Device> m_devices;
 
     std::vector<Channel> m_channels;
+    std::vector<OutputStage> m_stages;
+    std::map<const void*, std::unique_ptr<Panner>> m_panners; ///< mixer-side Spatializers by owner
 
     SPSCQueue<std::shared_ptr<Command>> m_commands;
+    SPSCQueue<std::shared_ptr<Command>> m_finished; ///< performed commands, destroyed by the control thread
     PaStream* m_stream;
+    bool m_offline = false;
+
+#ifdef SYNTACTS_USE_JACK
+    jack_client_t* m_jack = nullptr;
+    std::vector<jack_port_t*> m_jackPorts;
+    std::vector<float*> m_jackBuffers;
+    std::atomic_bool m_jackShutdown{false};
+    std::atomic<jack_nframes_t> m_framesPerBuffer{0};
+#endif
+
+    Recorder m_callbackStats;
+    std::unique_ptr<Recorder[]> m_channelStats;
+    std::atomic<int> m_queueDepth{0};
+    std::atomic<int> m_queueDepthMax{0};
+    std::atomic<unsigned long> m_lastFrames{0};
+    std::uint64_t m_frame = 0;      ///< frames rendered since the Session opened (audio thread)
+    std::atomic<double> m_time{0};  ///< m_frame in seconds, published for the control thread
+    std::atomic<std::uint64_t> m_xruns{0};
+    std::array<std::atomic<double>, 32> m_xrunTimes{}; ///< ring of the most recent xrun times
+    std::atomic_bool m_resetStats{false};
+    std::chrono::steady_clock::time_point m_openTime;
 
     double m_sampleRate = 0;
+    int m_maxVoices = SYNTACTS_MAX_VOICES;
+    double m_fadeTime = SYNTACTS_FADE_TIME;
+    std::atomic<VoiceStealing> m_stealing{VoiceStealing::Oldest};
+    std::atomic<std::uint32_t> m_voiceCounter{0};
 
     static int s_count;
 };
@@ -626,7 +2128,7 @@ Session::~Session() {
 }
 
 int Session::open() {
-    return open(getDefaultDevice());
+    return open(Impl::defaultDevice(m_impl->getEnumeratedDevices()));
 }
 
 int Session::open(const Device& device) {
@@ -637,10 +2139,14 @@ int Session::open(const Device& device, int channelCount, double sampleRate) {
     return m_impl->open(device, std::min(channelCount, device.maxChannels), sampleRate);
 }
 
+int Session::open(const Device& device, int channelCount, double sampleRate, int framesPerBuffer, double latency) {
+    return m_impl->open(device, std::min(channelCount, device.maxChannels), sampleRate, framesPerBuffer, latency);
+}
+
 int Session::open(API api) {
     if (api == API::Unknown)
         return SyntactsError_InvalidAPI;
-    for (auto& dev : getAvailableDevices()) {
+    for (auto& dev : m_impl->getEnumeratedDevices()) {
         if (dev.second.api == api && dev.second.isApiDefault)
             return open(dev.second);
     }
@@ -648,23 +2154,49 @@ int Session::open(API api) {
 }
 
 int Session::open(int index) {
-    if (getAvailableDevices().count(index) > 0)
-        return open(getAvailableDevices().at(index));
+    auto& devices = m_impl->getEnumeratedDevices();
+    if (devices.count(index) > 0)
+        return open(devices.at(index));
     else
         return SyntactsError_InvalidDevice;
 }
 
 int Session::open(int index, int channelCount, double sampleRate) {
-    if (getAvailableDevices().count(index) > 0)
-        return open(getAvailableDevices().at(index),channelCount, sampleRate);
+    auto& devices = m_impl->getEnumeratedDevices();
+    if (devices.count(index) > 0)
+        return open(devices.at(index),channelCount, sampleRate);
+    else
+        return SyntactsError_InvalidDevice;
+}
+
+int Session::open(int index, int channelCount, double sampleRate, int framesPerBuffer, double latency) {
+    auto& devices = m_impl->getEnumeratedDevices();
+    if (devices.count(index) > 0)
+        return open(devices.at(index), channelCount, sampleRate, framesPerBuffer, latency);
     else
         return SyntactsError_InvalidDevice;
 }
 
+int Session::openJack(int channelCount, const std::string& clientName, bool connect) {
+#ifdef SYNTACTS_USE_JACK
+    return m_impl->openJack(channelCount, clientName, connect);
+#else
+    return SyntactsError_InvalidAPI;
+#endif
+}
+
+int Session::openOffline(int channelCount, double sampleRate) {
+    return m_impl->openOffline(channelCount, sampleRate);
+}
+
+int Session::render(float** buffers, int frames) {
+    return m_impl->renderOffline(buffers, frames);
+}
+
 int Session::open(const std::string& name, API api) {
     if (api == API::Unknown)
         return SyntactsError_InvalidAPI;
-    for (auto& dev : getAvailableDevices()) {
+    for (auto& dev : m_impl->getEnumeratedDevices()) {
         if (dev.second.name == name && dev.second.api == api)
             return open(dev.second);
     }
@@ -679,8 +2211,40 @@ bool Session::isOpen() const {
     return m_impl->isOpen();
 }
 
-int Session::play(int channel, Signal signal) {
-    return m_impl->play(channel, std::move(signal));
+VoiceId Session::play(int channel, Signal signal) {
+    return m_impl->play(channel, std::move(signal), 0);
+}
+
+VoiceId Session::play(int channel, Signal signal, int priority) {
+    return m_impl->play(channel, std::move(signal), priority);
+}
+
+VoiceId Session::play(int channel, Signal signal, int priority, double volume, double time) {
+    return m_impl->play(channel, std::move(signal), priority, volume, time);
+}
+
+int Session::stop(const VoiceId& voice) {
+    return m_impl->stop(voice);
+}
+
+int Session::setVolume(const VoiceId& voice, double volume) {
+    return m_impl->setVolume(voice, volume);
+}
+
+int Session::setVolumes(const std::vector<VoiceId>& voices, const std::vector<double>& volumes) {
+    return m_impl->setVolumes(voices, volumes);
+}
+
+int Session::setPitch(const VoiceId& voice, double pitch) {
+    return m_impl->setPitch(voice, pitch);
+}
+
+bool Session::isPlaying(const VoiceId& voice) {
+    return m_impl->isPlaying(voice);
+}
+
+double Session::getTime(const VoiceId& voice) {
+    return m_impl->getTime(voice);
 }
 
 bool Session::isPlaying(int channel) {
@@ -739,6 +2303,37 @@ int Session::setVolume(int channel, double volume) {
     return m_impl->setVolume(channel, volume);
 }
 
+int Session::setVolumes(const std::vector<int>& channels, const std::vector<double>& volumes) {
+    return m_impl->setVolumes(channels, volumes);
+}
+
+int Session::setPanner(const void* owner, const std::vector<int>& channels, const std::vector<double>& x, const std::vector<double>& y, 
+                       const std::vector<double>& z, double radius, Curve rollOff, double wrapX, double wrapY, double wrapZ, double volume, 
+                       double targetX, double targetY, double targetZ) 
+{
+    return m_impl->setPanner(owner, channels, x, y, z, radius, std::move(rollOff), wrapX, wrapY, wrapZ, volume, targetX, targetY, targetZ);
+}
+
+int Session::removePanner(const void* owner) {
+    return m_impl->removePanner(owner);
+}
+
+int Session::setPannerTarget(const void* owner, double x, double y, double z) {
+    return m_impl->setPannerTarget(owner, x, y, z);
+}
+
+int Session::addPannerWaypoint(const void* owner, double time, double x, double y, double z) {
+    return m_impl->addPannerWaypoint(owner, time, x, y, z);
+}
+
+int Session::setPannerPath(const void* owner, Signal x, Signal y, Signal z) {
+    return m_impl->setPannerPath(owner, std::move(x), std::move(y), std::move(z));
+}
+
+double Session::getTime() const {
+    return m_impl->getTime();
+}
+
 double Session::getVolume(int channel) {
     return m_impl->getVolume(channel);
 }
@@ -756,6 +2351,42 @@ double Session::getLevel(int channel) {
     return m_impl->getLevel(channel);
 }
 
+int Session::setMaxVoices(int voices) {
+    return m_impl->setMaxVoices(voices);
+}
+
+int Session::getMaxVoices() const {
+    return m_impl->getMaxVoices();
+}
+
+int Session::getVoiceCount(int channel) {
+    return m_impl->getVoiceCount(channel);
+}
+
+void Session::setVoiceStealing(VoiceStealing policy) {
+    m_impl->m_stealing = policy;
+}
+
+VoiceStealing Session::getVoiceStealing() const {
+    return m_impl->m_stealing;
+}
+
+int Session::setOutputStage(int channel, const OutputStage& stage) {
+    return m_impl->setOutputStage(channel, stage);
+}
+
+const OutputStage& Session::getOutputStage(int channel) const {
+    return m_impl->getOutputStage(channel);
+}
+
+int Session::setFadeTime(double seconds) {
+    return m_impl->setFadeTime(seconds);
+}
+
+double Session::getFadeTime() const {
+    return m_impl->m_fadeTime;
+}
+
 const Device& Session::getCurrentDevice() const {
     return m_impl->getCurrentDevice();
 }
@@ -780,6 +2411,18 @@ double Session::getCpuLoad() const {
     return m_impl->getCpuLoad();
 }
 
+double Session::getLatency() const {
+    return m_impl->getLatency();
+}
+
+SessionStats Session::getStats() const {
+    return m_impl->getStats();
+}
+
+void Session::resetStats() {
+    m_impl->resetStats();
+}
+
 int Session::count() {
     return Impl::count();
 }
@@ -22,11 +22,17 @@ std::type_index Signal::typeId() const
     return m_ptr->typeId(); 
 }
 
-void* Signal::get() const
+void* Signal::get()
 { 
+    m_ptr->expose();
     return m_ptr->get(); 
 }
 
-int Signal::Concept::s_count = 0;
+const void* Signal::get() const
+{ 
+    return m_ptr->get(); 
+}
+
+std::atomic<int> Signal::Concept::s_count(0);
 
 } // namespace tact
\ No newline at end of file
@@ -1,4 +1,7 @@
 #include <Tact/Spatializer.hpp>
+#include <algorithm>
+#include <limits>
+#include <numeric>
 
 namespace tact {
 
@@ -9,6 +12,28 @@ inline double wrappedDifference(double p1, double p2, double interval) {
     return p1 - p2 - floor(((p1 - p2) + interval * 0.5) / interval) * interval;
 }
 
+/// Adds the squared distance along one axis from n positions p to target t into g. The wrap test 
+/// is hoisted out of the loops so each is a straight pass the compiler can vectorize.
+inline void addSquaredDistance(const double* p, double t, double wrap, int n, double* g) {
+    if (wrap > 0) {
+        for (int i = 0; i < n; ++i) {
+            double d = wrappedDifference(p[i], t, wrap);
+            g[i] += d * d;
+        }
+    }
+    else {
+        for (int i = 0; i < n; ++i) {
+            double d = p[i] - t;
+            g[i] += d * d;
+        }
+    }
+}
+
+/// Packs grid cell coordinates into a single key
+inline std::int64_t cellKey(std::int64_t i, std::int64_t j, std::int64_t k) {
+    return ((i & 0x1FFFFF) << 42) | ((j & 0x1FFFFF) << 21) | (k & 0x1FFFFF);
+}
+
 Spatializer::Spatializer(Session* session) :
     m_session(session),
     m_target({0.5,0.5}),
@@ -17,7 +42,10 @@ Spatializer::Spatializer(Session* session) :
     m_pitch(1),
     m_rollOff(Curves::Linear()),
     m_autoUpdate(true),
-    m_wrapInterval({0,0})
+    m_wrapInterval({0,0}),
+    m_mode(Control),
+    m_nextTarget(1),
+    m_gridDirty(true)
 {
     
 }
@@ -32,44 +60,100 @@ void Spatializer::bind(Session* session) {
 } 
 
 void Spatializer::unbind() {
-    if (m_session)
-    {
-        for (auto& pair : m_positions) {
-            int ch = pair.first;
-            m_session->stop(ch);
-            m_session->setVolume(ch, 1.0f);
-            m_session->setPitch(ch, 1.0f);
-        }
-    }
+    release();
     m_session = nullptr;
 }
 
-void Spatializer::setPosition(int channel, double x, double y) {
-    m_positions[channel] = {x,y};
+void Spatializer::setPosition(int channel, double x, double y, double z) {
+    auto it = std::lower_bound(m_channels.begin(), m_channels.end(), channel);
+    auto i  = it - m_channels.begin();
+    if (it == m_channels.end() || *it != channel) {
+        m_channels.insert(it, channel);
+        m_x.insert(m_x.begin() + i, x);
+        m_y.insert(m_y.begin() + i, y);
+        m_z.insert(m_z.begin() + i, z);
+        m_gains.push_back(0);
+    }
+    else {
+        m_x[i] = x;
+        m_y[i] = y;
+        m_z[i] = z;
+    }
+    m_gridDirty = true;
     if (m_autoUpdate)
         update();
 }
 
 void Spatializer::setPosition(int channel, const Point& p) {
-    m_positions[channel] = p;
+    setPosition(channel, p.x, p.y, p.z);
+}
+
+void Spatializer::setPositions(const std::vector<int>& channels, const std::vector<Point>& positions) {
+    assert(channels.size() == positions.size());
+    std::size_t n = std::min(channels.size(), positions.size());
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return channels[a] < channels[b]; });
+    // merge the sorted new positions with the existing ones in a single pass
+    std::vector<int> ch;
+    std::vector<double> x, y, z;
+    ch.reserve(m_channels.size() + n);
+    x.reserve(m_channels.size() + n);
+    y.reserve(m_channels.size() + n);
+    z.reserve(m_channels.size() + n);
+    std::size_t i = 0, j = 0;
+    while (i < m_channels.size() || j < n) {
+        if (j == n || (i < m_channels.size() && m_channels[i] < channels[order[j]])) {
+            ch.push_back(m_channels[i]);
+            x.push_back(m_x[i]);
+            y.push_back(m_y[i]);
+            z.push_back(m_z[i]);
+            ++i;
+            continue;
+        }
+        // the last position given for a channel wins
+        const auto& p = positions[order[j]];
+        int c = channels[order[j++]];
+        if (i < m_channels.size() && m_channels[i] == c)
+            ++i;
+        if (!ch.empty() && ch.back() == c) {
+            x.back() = p.x;
+            y.back() = p.y;
+            z.back() = p.z;
+            continue;
+        }
+        ch.push_back(c);
+        x.push_back(p.x);
+        y.push_back(p.y);
+        z.push_back(p.z);
+    }
+    m_channels.swap(ch);
+    m_x.swap(x);
+    m_y.swap(y);
+    m_z.swap(z);
+    m_gains.resize(m_channels.size());
+    m_gridDirty = true;
     if (m_autoUpdate)
         update();
 }
 
 Spatializer::Point Spatializer::getPosition(int channel) const {
-    return m_positions.at(channel);
+    int i = indexOf(channel);
+    if (i < 0)
+        return {0,0};
+    return {m_x[i], m_y[i], m_z[i]};
 }
 
-void Spatializer::setTarget(double x, double y) {
-    m_target = {x,y};
-    if (m_autoUpdate)
-        update();
+void Spatializer::setTarget(double x, double y, double z) {
+    setTarget({x,y,z});
 }
 
 void Spatializer::setTarget(const Point& p) {
     m_target = p;
-    if (m_autoUpdate)
-        update();
+    if (m_mode == Mixer && m_session && m_targets.empty())
+        m_session->setPannerTarget(this, p.x, p.y, p.z);
+    else if (m_autoUpdate && m_targets.empty())
+        updatePrimary();
 }
 
 const Spatializer::Point& Spatializer::getTarget() const {
@@ -97,9 +181,10 @@ Curve Spatializer::getRollOff() const {
     return m_rollOff;
 }
 
-void Spatializer::setWrap(double x_interval, double y_interval) {
+void Spatializer::setWrap(double x_interval, double y_interval, double z_interval) {
     m_wrapInterval.x = x_interval;
     m_wrapInterval.y = y_interval;
+    m_wrapInterval.z = z_interval;
 }
 
 void Spatializer::setWrap(const Point& wrapInterval) {
@@ -120,7 +205,11 @@ bool Spatializer::createGrid(int rows, int cols) {
                 return false;
             float x = (float)c / (float)(cols-1);
             float y = (float)r / (float)(rows-1);
-            m_positions[ch] = {x,y};
+            m_channels.push_back(ch);
+            m_x.push_back(x);
+            m_y.push_back(y);
+            m_z.push_back(0);
+            m_gains.push_back(0);
             ch++;
         }
     }
@@ -128,56 +217,73 @@ bool Spatializer::createGrid(int rows, int cols) {
 }
 
 void Spatializer::clear() {
-    if (m_session) {
-        for (auto& pair : m_positions) {
-            int ch = pair.first;
-            m_session->stop(ch);
-            m_session->setVolume(ch, 1.0);
-            m_session->setPitch(ch, 1.0);
-        }
-    } 
-    m_positions.clear();        
+    release();
+    m_channels.clear();
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_gains.clear();
+    m_gridDirty = true;
 }
 
 void Spatializer::remove(int channel) {
-    if (m_positions.count(channel)) {
+    int i = indexOf(channel);
+    if (i >= 0) {
         if (m_session) {
             m_session->stop(channel);
             m_session->setVolume(channel, 1.0);
             m_session->setPitch(channel, 1.0);
         }
-        m_positions.erase(channel);
+        m_channels.erase(m_channels.begin() + i);
+        m_x.erase(m_x.begin() + i);
+        m_y.erase(m_y.begin() + i);
+        m_z.erase(m_z.begin() + i);
+        m_gains.pop_back();
+        m_gridDirty = true;
+        // stopping the channel stopped the voices of any targets on it
+        for (auto& t : m_targets) {
+            auto it = std::lower_bound(t.channels.begin(), t.channels.end(), channel);
+            if (it != t.channels.end() && *it == channel) {
+                t.voices.erase(t.voices.begin() + (it - t.channels.begin()));
+                t.channels.erase(it);
+            }
+        }
+        // the mixer must stop positioning the channel even if updates are manual
+        if (m_mode == Mixer && m_targets.empty())
+            updatePrimary();
     }
 }
 
 int Spatializer::getChannelCount() const {
-    return (int)m_positions.size();
+    return (int)m_channels.size();
 }
 
 std::vector<int> Spatializer::getChannels() const {
-    std::vector<int> channels;
-    channels.reserve(m_positions.size());
-    for (auto& c : m_positions)
-        channels.push_back(c.first);
-    return channels;
+    return m_channels;
 }
 
 bool Spatializer::hasChannel(int channel) const {
-    return m_positions.count(channel) > 0;
+    return indexOf(channel) >= 0;
 }
 
 void Spatializer::play(Signal signal) {
     if (m_session == nullptr)
         return;
-    for (auto& pair : m_positions) 
-        m_session->play(pair.first, signal);
+    for (auto& ch : m_channels) 
+        m_session->play(ch, signal);
 }
 
 void Spatializer::stop() {
     if (m_session == nullptr)
         return;
-    for (auto& pair : m_positions) 
-        m_session->stop(pair.first);
+    for (auto& ch : m_channels) 
+        m_session->stop(ch);
+    // the channels are stopped, so the targets only need forgetting
+    for (auto& t : m_targets) {
+        t.channels.clear();
+        t.voices.clear();
+    }
+    clearTargets();
 }
 
 void Spatializer::setVolume(double volume) {
@@ -194,14 +300,139 @@ void Spatializer::setPitch(double pitch) {
     m_pitch = pitch;
     if (m_session == nullptr)
         return;
-    for (auto& pair : m_positions) 
-        m_session->setPitch(pair.first, m_pitch);
+    for (auto& ch : m_channels) 
+        m_session->setPitch(ch, m_pitch);
 }    
 
 double Spatializer::getPitch() const {
     return m_pitch;
 }
 
+void Spatializer::setMode(Mode mode) {
+    if (mode == m_mode)
+        return;
+    m_mode = mode;
+    if (m_session == nullptr || !m_targets.empty())
+        return;
+    if (m_mode == Mixer) {
+        // the mixer applies its own gains on top of channel volumes
+        m_session->setVolumes(m_channels, std::vector<double>(m_channels.size(), 1.0));
+        updatePrimary();
+    }
+    else {
+        m_session->removePanner(this);
+        updatePrimary();
+    }
+}
+
+Spatializer::Mode Spatializer::getMode() const {
+    return m_mode;
+}
+
+void Spatializer::addWaypoint(double time, double x, double y, double z) {
+    addWaypoint(time, {x,y,z});
+}
+
+void Spatializer::addWaypoint(double time, const Point& p) {
+    if (m_mode != Mixer) {
+        setTarget(p);
+        return;
+    }
+    m_target = p;
+    if (m_session)
+        m_session->addPannerWaypoint(this, time, p.x, p.y, p.z);
+}
+
+void Spatializer::setPath(Signal x, Signal y, Signal z) {
+    if (m_mode == Mixer && m_session)
+        m_session->setPannerPath(this, std::move(x), std::move(y), std::move(z));
+}
+
+int Spatializer::addTarget(const Point& p, Signal signal, double radius, Curve rollOff, double volume) {
+    assert(radius > 0);
+    if (m_targets.empty() && m_session) {
+        // added targets replace the primary target, so give them unscaled channels
+        if (m_mode == Mixer)
+            m_session->removePanner(this);
+        m_session->setVolumes(m_channels, std::vector<double>(m_channels.size(), 1.0));
+    }
+    Target t;
+    t.id       = m_nextTarget++;
+    t.position = p;
+    t.radius   = radius;
+    t.rollOff  = std::move(rollOff);
+    t.volume   = volume;
+    t.signal   = std::move(signal);
+    t.start    = m_session ? m_session->getTime() : 0;
+    if (radius > m_grid.cell)
+        m_gridDirty = true;
+    m_targets.push_back(std::move(t));
+    updateTarget(m_targets.back());
+    return m_targets.back().id;
+}
+
+void Spatializer::moveTarget(int id, const Point& p) {
+    if (auto t = findTarget(id)) {
+        t->position = p;
+        if (m_autoUpdate)
+            updateTarget(*t);
+    }
+}
+
+void Spatializer::setTargetRadius(int id, double r) {
+    assert(r > 0);
+    if (auto t = findTarget(id)) {
+        t->radius = r;
+        if (r > m_grid.cell)
+            m_gridDirty = true;
+        if (m_autoUpdate)
+            updateTarget(*t);
+    }
+}
+
+void Spatializer::setTargetVolume(int id, double volume) {
+    if (auto t = findTarget(id)) {
+        t->volume = volume;
+        if (m_autoUpdate)
+            updateTarget(*t);
+    }
+}
+
+void Spatializer::removeTarget(int id) {
+    auto it = std::find_if(m_targets.begin(), m_targets.end(), [id](const Target& t) { return t.id == id; });
+    if (it == m_targets.end())
+        return;
+    if (m_session) {
+        for (auto& v : it->voices)
+            m_session->stop(v);
+    }
+    m_targets.erase(it);
+    // hand the channels back to the primary target
+    if (m_targets.empty() && m_autoUpdate)
+        updatePrimary();
+}
+
+void Spatializer::clearTargets() {
+    while (!m_targets.empty())
+        removeTarget(m_targets.back().id);
+}
+
+Spatializer::Point Spatializer::getTargetPosition(int id) const {
+    for (auto& t : m_targets) {
+        if (t.id == id)
+            return t.position;
+    }
+    return {0,0};
+}
+
+std::vector<int> Spatializer::getTargets() const {
+    std::vector<int> ids;
+    ids.reserve(m_targets.size());
+    for (auto& t : m_targets)
+        ids.push_back(t.id);
+    return ids;
+}
+
 void Spatializer::autoUpdate(bool enable) {
     m_autoUpdate = enable;
 }
@@ -209,21 +440,165 @@ void Spatializer::autoUpdate(bool enable) {
 void Spatializer::update() {
     if (m_session == nullptr)
         return;
-    for (auto& pair : m_positions) {
-        int ch = pair.first;
-        Point v;
-        v.x = m_wrapInterval.x > 0 
-            ? wrappedDifference(pair.second.x, m_target.x, m_wrapInterval.x)
-            : pair.second.x - m_target.x;
-        
-        v.y = m_wrapInterval.y > 0 
-            ? wrappedDifference(pair.second.y, m_target.y, m_wrapInterval.y)
-            : v.y = pair.second.y - m_target.y; 
-        double d = std::sqrt(v.x*v.x + v.y*v.y);
-        double vol = 1.0 - clamp01(d / m_radius);
-        vol = m_rollOff(vol);
-        vol *= m_volume;
-        m_session->setVolume(ch, vol);
+    if (m_targets.empty())
+        updatePrimary();
+    for (auto& t : m_targets)
+        updateTarget(t);
+}
+
+void Spatializer::updatePrimary() {
+    if (m_session == nullptr)
+        return;
+    if (m_mode == Mixer) {
+        m_session->setPanner(this, m_channels, m_x, m_y, m_z, m_radius, m_rollOff, m_wrapInterval.x, m_wrapInterval.y, 
+                             m_wrapInterval.z, m_volume, m_target.x, m_target.y, m_target.z);
+        return;
+    }
+    if (m_channels.empty())
+        return;
+    const int n = (int)m_channels.size();
+    double* g = m_gains.data();
+    std::fill(g, g + n, 0.0);
+    addSquaredDistance(m_x.data(), m_target.x, m_wrapInterval.x, n, g);
+    addSquaredDistance(m_y.data(), m_target.y, m_wrapInterval.y, n, g);
+    addSquaredDistance(m_z.data(), m_target.z, m_wrapInterval.z, n, g);
+    const double r = m_radius;
+    for (int i = 0; i < n; ++i)
+        g[i] = 1.0 - std::min(std::sqrt(g[i]) / r, 1.0);
+    for (int i = 0; i < n; ++i)
+        g[i] = m_rollOff(g[i]) * m_volume;
+    // one command for all channels, so they change together on the audio thread
+    m_session->setVolumes(m_channels, m_gains);
+}
+
+void Spatializer::updateTarget(Target& t) {
+    if (m_session == nullptr)
+        return;
+    query(t.position, t.radius, m_nearby);
+    auto& channels = m_scratchChannels;
+    auto& voices   = m_scratchVoices;
+    auto& batch    = m_scratchBatch;
+    auto& gains    = m_scratchGains;
+    channels.clear();
+    voices.clear();
+    batch.clear();
+    gains.clear();
+    double time = std::max(0.0, m_session->getTime() - t.start);
+    // merge the channels now in range with those in range at the last update (both sorted)
+    std::size_t j = 0;
+    for (int i : m_nearby) {
+        double dx = m_wrapInterval.x > 0 ? wrappedDifference(m_x[i], t.position.x, m_wrapInterval.x) : m_x[i] - t.position.x;
+        double dy = m_wrapInterval.y > 0 ? wrappedDifference(m_y[i], t.position.y, m_wrapInterval.y) : m_y[i] - t.position.y;
+        double dz = m_wrapInterval.z > 0 ? wrappedDifference(m_z[i], t.position.z, m_wrapInterval.z) : m_z[i] - t.position.z;
+        double d  = std::sqrt(dx * dx + dy * dy + dz * dz);
+        if (!(d < t.radius))
+            continue;
+        int ch = m_channels[i];
+        for (; j < t.channels.size() && t.channels[j] < ch; ++j)
+            m_session->stop(t.voices[j]);
+        double gain = t.rollOff(1.0 - d / t.radius) * t.volume * m_volume;
+        channels.push_back(ch);
+        if (j < t.channels.size() && t.channels[j] == ch) {
+            voices.push_back(t.voices[j++]);
+            if (voices.back().error == SyntactsError_NoError) {
+                batch.push_back(voices.back());
+                gains.push_back(gain);
+            }
+        }
+        else {
+            // join the target's other voices part way through its Signal
+            voices.push_back(m_session->play(ch, t.signal, 0, gain, time));
+        }
+    }
+    for (; j < t.channels.size(); ++j)
+        m_session->stop(t.voices[j]);
+    t.channels.swap(channels);
+    t.voices.swap(voices);
+    if (!batch.empty())
+        m_session->setVolumes(batch, gains);
+}
+
+void Spatializer::query(const Point& p, double r, std::vector<int>& indices) {
+    indices.clear();
+    if (m_channels.empty())
+        return;
+    if (m_gridDirty) {
+        m_grid.cells.clear();
+        m_grid.cell = m_radius;
+        for (auto& t : m_targets)
+            m_grid.cell = std::max(m_grid.cell, t.radius);
+        for (int a = 0; a < 3; ++a) {
+            m_grid.lo[a] = std::numeric_limits<int>::max();
+            m_grid.hi[a] = std::numeric_limits<int>::min();
+        }
+        for (int i = 0; i < (int)m_channels.size(); ++i) {
+            std::array<int,3> c = {(int)std::floor(m_x[i] / m_grid.cell), 
+                                   (int)std::floor(m_y[i] / m_grid.cell), 
+                                   (int)std::floor(m_z[i] / m_grid.cell)};
+            for (int a = 0; a < 3; ++a) {
+                m_grid.lo[a] = std::min(m_grid.lo[a], c[a]);
+                m_grid.hi[a] = std::max(m_grid.hi[a], c[a]);
+            }
+            m_grid.cells[cellKey(c[0], c[1], c[2])].push_back(i);
+        }
+        m_gridDirty = false;
+    }
+    // visit the cells overlapping the target's bounding box (every cell along wrapped axes)
+    const double center[3] = {p.x, p.y, p.z};
+    const double wrap[3]   = {m_wrapInterval.x, m_wrapInterval.y, m_wrapInterval.z};
+    int lo[3], hi[3];
+    for (int a = 0; a < 3; ++a) {
+        lo[a] = m_grid.lo[a];
+        hi[a] = m_grid.hi[a];
+        if (!(wrap[a] > 0)) {
+            lo[a] = std::max(lo[a], (int)std::floor((center[a] - r) / m_grid.cell));
+            hi[a] = std::min(hi[a], (int)std::floor((center[a] + r) / m_grid.cell));
+        }
+    }
+    for (int i = lo[0]; i <= hi[0]; ++i) {
+        for (int j = lo[1]; j <= hi[1]; ++j) {
+            for (int k = lo[2]; k <= hi[2]; ++k) {
+                auto it = m_grid.cells.find(cellKey(i, j, k));
+                if (it != m_grid.cells.end())
+                    indices.insert(indices.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+    std::sort(indices.begin(), indices.end());
+}
+
+int Spatializer::indexOf(int channel) const {
+    auto it = std::lower_bound(m_channels.begin(), m_channels.end(), channel);
+    if (it == m_channels.end() || *it != channel)
+        return -1;
+    return (int)(it - m_channels.begin());
+}
+
+Spatializer::Target* Spatializer::findTarget(int id) {
+    for (auto& t : m_targets) {
+        if (t.id == id)
+            return &t;
+    }
+    return nullptr;
+}
+
+void Spatializer::release() {
+    if (m_session == nullptr)
+        return;
+    if (m_mode == Mixer)
+        m_session->removePanner(this);
+    // stopping the channels stops the targets' voices, which start again at their next update
+    for (auto& t : m_targets) {
+        t.channels.clear();
+        t.voices.clear();
     }
+    if (m_channels.empty())
+        return;
+    for (auto& ch : m_channels) {
+        m_session->stop(ch);
+        m_session->setPitch(ch, 1.0);
+    }
+    m_session->setVolumes(m_channels, std::vector<double>(m_channels.size(), 1.0));
 }
+
 }
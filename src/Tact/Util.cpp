@@ -37,6 +37,9 @@ const std::string& signalName(const Signal& signal) {
         {typeid(Time),             "Time"},
         {typeid(Ramp),             "Ramp"},
         {typeid(Noise),            "Noise"},
+        {typeid(PinkNoise),        "Pink Noise"},
+        {typeid(BrownNoise),       "Brown Noise"},
+        {typeid(BandLimitedNoise), "Band Limited Noise"},
         {typeid(Expression),       "Expression"},
         {typeid(PolyBezier),       "PolyBezier"},
         {typeid(Samples),          "Samples"},
@@ -61,7 +64,8 @@ const std::string& signalName(const Signal& signal) {
         // Process.hpp
         {typeid(Repeater),         "Repeater"},
         {typeid(Stretcher),        "Stretcher"},
-        {typeid(Reverser),         "Reverser"}};
+        {typeid(Reverser),         "Reverser"},
+        {typeid(Filter),           "Filter"}};
     if (names.count(id))
         return names[id];
     else
@@ -91,6 +95,8 @@ void recurseSignalPriv(const Signal& sig, std::function<void(const Signal&, int
         recurseSignalPriv(sig.getAs<Stretcher>()->signal,func,depth+1);
     else if (id == typeid(Reverser))
         recurseSignalPriv(sig.getAs<Reverser>()->signal,func,depth+1);   
+    else if (id == typeid(Filter))
+        recurseSignalPriv(sig.getAs<Filter>()->signal,func,depth+1);
     else if (id == typeid(Sine))
          recurseSignalPriv(sig.getAs<Sine>()->x,func,depth+1);
     else if (id == typeid(Square))
@@ -0,0 +1,76 @@
+#include <syntacts>
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <new>
+
+// Checks that the mixer neither allocates nor frees while rendering. Global operator new/delete
+// are replaced with counting versions, and counts are only taken while Session::render runs.
+// An offline Session is used so commands are performed on this thread inside render, just as
+// they would be on the audio thread. Exits with 1 if any heap activity is seen.
+
+namespace {
+thread_local bool t_rendering = false;
+std::size_t g_allocs = 0;
+std::size_t g_frees  = 0;
+}
+
+void* operator new(std::size_t size) {
+    if (t_rendering)
+        ++g_allocs;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    if (p && t_rendering)
+        ++g_frees;
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+using namespace tact;
+
+int main()
+{
+    const int channels = 4;
+    const int frames   = 256;
+    Session session;
+    session.setMaxVoices(4);
+    session.openOffline(channels, 48000);
+    std::vector<float> buffer(channels * frames);
+    std::vector<float*> out(channels);
+    for (int c = 0; c < channels; ++c)
+        out[c] = &buffer[c * frames];
+
+    auto render = [&](int buffers) {
+        for (int i = 0; i < buffers; ++i) {
+            t_rendering = true;
+            session.render(out.data(), frames);
+            t_rendering = false;
+        }
+    };
+
+    render(1);
+    for (int i = 0; i < 200; ++i) {
+        // stateful, nested Signals so voices own contexts and Concept trees
+        Signal sig = Filter(Sine(100 + i) * Noise(), Filter::LowPass, 200 + i, 0.7, 4) * ASR(0.01, 0.02, 0.01);
+        session.play(i % channels, sig, i % 3);
+        if (i % 5 == 0)
+            session.stop(i % channels);
+        if (i % 7 == 0)
+            session.setVolume(i % channels, 0.5 + 0.001 * i);
+        render(2);
+    }
+    session.stopAll();
+    render(8);
+    session.close();
+
+    std::cout << "allocations during render: " << g_allocs << std::endl;
+    std::cout << "frees during render:       " << g_frees << std::endl;
+    return g_allocs == 0 && g_frees == 0 ? 0 : 1;
+}
@@ -1,72 +1,304 @@
 #include <syntacts>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <numeric>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+
+// Micro and macro benchmarks for Syntacts.
+// Usage: benchmark [--filter substring] [--json file] [--min-time seconds] [--repetitions n]
+//
+// Each benchmark runs in batches until min-time has elapsed, and the median of the repetitions is
+// reported as time per item (e.g. per sample or per frame). JSON output uses the same layout as
+// Google Benchmark, so tools/compare_benchmarks.py (or Google's compare.py) can diff two runs.
 
 using namespace tact;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Benchmark {
+    std::string name;
+    int items;                    ///< items processed per call to run (e.g. samples)
+    std::function<void()> run;
+};
 
-void display(double t, int n, float sum, const std::string& benchmark) {
-    std::cout << std::endl;
-    std::cout << " Benchmark: " << benchmark << std::endl;
-    std::cout << " Time:      " << t << " s" << std::endl;
-    std::cout << " Frequency: " << n / t / 1000 << " kHz" << std::endl;
-    std::cout << " Channels:  " << (n / t) / 48000 << std::endl;
-    std::cout << " Sum:       " << sum << std::endl;
+struct Result {
+    std::string name;
+    std::uint64_t iterations;
+    double ns;                    ///< median ns per item
+    double itemsPerSecond;
+};
+
+std::vector<Benchmark>& registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
 }
 
-int main(int argc, char const *argv[])
-{
-    int n = 100000000;        // one billion benchmark iterations
-    volatile float sum = 0; // benchmark accumulator to trick compiler
-
-    int bufferSize = 32;
-    std::vector<float> sBuffer(bufferSize);
-    std::vector<float> tBuffer(bufferSize);
-
-    auto env = Envelope();
-  
-    Signal sig = Sine(2 * PI * 175 * Time() + 2 * Sine(10)) * env;
-    tic();
-    float lenN = sig.length() / n;
-    for (int i = 0; i < n; ++i) {
-        auto t = i * lenN;
-        sum += sig.sample(t);
+void add(const std::string& name, int items, std::function<void()> run) {
+    registry().push_back({name, items, std::move(run)});
+}
+
+volatile double g_sink = 0; // accumulator to keep results alive
+
+constexpr int    BLOCK = 256;
+constexpr double DT    = 1.0 / 48000;
+
+/// Samples a Signal one t at a time
+void addScalar(const std::string& name, Signal sig) {
+    add("Scalar/" + name, BLOCK, [sig, t = 0.0]() mutable {
+        double sum = 0;
+        for (int i = 0; i < BLOCK; ++i, t += DT)
+            sum += sig.sample(t);
+        t = t > 1 ? 0 : t;
+        g_sink = g_sink + sum;
+    });
+}
+
+/// Samples a Signal a block at a time through a per-voice context, as a Session does
+void addBlock(const std::string& name, Signal sig) {
+    auto ctx = std::make_shared<Signal::Context>();
+    sig.prepare(*ctx);
+    add("Block/" + name, BLOCK, [sig, ctx, t = 0.0]() mutable {
+        double ts[BLOCK], bs[BLOCK];
+        for (int i = 0; i < BLOCK; ++i, t += DT)
+            ts[i] = t;
+        t = t > 1 ? 0 : t;
+        sig.process(ctx.get(), ts, bs, BLOCK);
+        g_sink = g_sink + bs[0];
+    });
+}
+
+void addSignal(const std::string& name, Signal sig) {
+    addScalar(name, sig);
+    addBlock(name, sig);
+}
+
+void addCurve(const std::string& name, Curve curve) {
+    add("Curve/" + name, BLOCK, [curve]() {
+        double sum = 0;
+        for (int i = 0; i < BLOCK; ++i)
+            sum += curve(i / double(BLOCK - 1));
+        g_sink = g_sink + sum;
+    });
+}
+
+void registerSignals() {
+    PolyBezier bezier;
+    bezier.points = {{{0,0},{0,0},{0.1,1}}, {{0.4,1},{0.5,0},{0.6,-1}}, {{0.9,0},{1,0},{1,0}}};
+    bezier.solve();
+    std::vector<float> recorded(48000);
+    for (std::size_t i = 0; i < recorded.size(); ++i)
+        recorded[i] = static_cast<float>(std::sin(TWO_PI * 175 * i / 48000.0));
+
+    addSignal("Time", Time());
+    addSignal("Scalar", Scalar(0.5));
+    addSignal("Ramp", Ramp(0, 1, 1));
+    addSignal("Noise", Noise());
+    addSignal("PinkNoise", PinkNoise());
+    addSignal("BrownNoise", BrownNoise());
+    addSignal("BandLimitedNoise", BandLimitedNoise(100));
+    addSignal("Expression", Expression("sin(2*pi*175*t+2*sin(2*pi*10*t))"));
+    addSignal("PolyBezier", bezier);
+    addSignal("Samples", Samples(recorded, 48000));
+    addSignal("Sine", Sine(175));
+    addSignal("Square", Square(175));
+    addSignal("Saw", Saw(175));
+    addSignal("Triangle", Triangle(175));
+    addSignal("Pwm", Pwm(175, 0.25));
+    addSignal("SineFM", Sine(175, Sine(10), 2));
+    addSignal("Envelope", Envelope(1));
+    addSignal("ASR", ASR(0.25, 0.5, 0.25));
+    addSignal("ADSR", ADSR(0.25, 0.25, 0.25, 0.25));
+    addSignal("ExponentialDecay", ExponentialDecay());
+    addSignal("SignalEnvelope", SignalEnvelope(Sine(10), 1));
+    addSignal("Sum", Sine(175) + Sine(250));
+    addSignal("Product", Sine(175) * ASR(0.25, 0.5, 0.25));
+    addSignal("Repeater", Repeater(Sine(175) * Envelope(0.05), 10, 0.05));
+    addSignal("Stretcher", Stretcher(Sine(175) * Envelope(0.5), 2));
+    addSignal("Reverser", Reverser(Sine(175) * ASR(0.25, 0.5, 0.25)));
+    addSignal("Filter", Filter(Noise(), Filter::LowPass, 200, 0.7071, 4));
+    addSignal("Composite", Sine(175, Sine(10), 2) * ADSR(0.25, 0.25, 0.25, 0.25) + 0.1 * Noise());
+}
+
+void registerCurves() {
+    addCurve("Linear", Curves::Linear());
+    addCurve("Smoothstep", Curves::Smoothstep());
+    addCurve("Smootherstep", Curves::Smootherstep());
+    addCurve("Smootheststep", Curves::Smootheststep());
+    addCurve("Quadratic::InOut", Curves::Quadratic::InOut());
+    addCurve("Cubic::InOut", Curves::Cubic::InOut());
+    addCurve("Quartic::InOut", Curves::Quartic::InOut());
+    addCurve("Quintic::InOut", Curves::Quintic::InOut());
+    addCurve("Sinusoidal::InOut", Curves::Sinusoidal::InOut());
+    addCurve("Exponential::InOut", Curves::Exponential::InOut());
+    addCurve("Circular::InOut", Curves::Circular::InOut());
+    addCurve("Elastic::InOut", Curves::Elastic::InOut());
+    addCurve("Back::InOut", Curves::Back::InOut());
+    addCurve("Bounce::InOut", Curves::Bounce::InOut());
+}
+
+void registerSequences() {
+    for (int keys : {10, 100, 1000, 10000}) {
+        // overlapping keys spread over one second
+        Sequence seq;
+        for (int k = 0; k < keys; ++k)
+            seq.insert(Sine(100 + k % 200) * Envelope(0.01), k * (1.0 / keys));
+        addSignal("Sequence/" + std::to_string(keys), seq);
     }
-    display(toc(), n, sum, "Manual");
-
-    sig = Sine(175, Sine(10),2) * env;
-    sum = 0;
-    tic();
-    for (int i = 0; i < n; ++i) {
-        auto t = i * lenN;
-        sum += sig.sample(t);
+}
+
+/// Full mixer: every channel and voice rendered through an offline Session (items are frames)
+void registerMixer() {
+    for (int channels : {1, 8}) {
+        for (int voices : {1, 8}) {
+            auto session = std::make_shared<Session>();
+            session->setMaxVoices(voices);
+            session->openOffline(channels);
+            auto buffers = std::make_shared<std::vector<std::vector<float>>>(channels, std::vector<float>(BLOCK));
+            auto ptrs = std::make_shared<std::vector<float*>>();
+            for (auto& b : *buffers)
+                ptrs->push_back(b.data());
+            std::string name = "Mixer/" + std::to_string(channels) + "ch/" + std::to_string(voices) + "v";
+            add(name, BLOCK, [session, buffers, ptrs, channels, voices]() {
+                // keep every voice busy
+                for (int c = 0; c < channels; ++c) {
+                    for (int v = session->getVoiceCount(c); v < voices; ++v)
+                        session->play(c, Sine(175, Sine(10), 2) * ASR(0.25, 0.5, 0.25));
+                }
+                session->render(ptrs->data(), BLOCK);
+                g_sink = g_sink + (*buffers)[0][0];
+            });
+        }
     }
-    display(toc(), n, sum, "Auto");
-
-    sig = Expression("sin(2*pi*175*t+2*sin(2*pi*10*t))") * env;
-    sum = 0;
-    tic();
-    for (int i = 0; i < n; ++i) {
-        auto t = i * lenN;
-        sum += sig.sample(t);
+}
+
+/// Library round trips (items are calls)
+void registerLibrary() {
+    Signal sig = (Sine(175, Sine(10), 2) + 0.1 * Noise()) * ADSR(0.25, 0.25, 0.25, 0.25);
+    add("Library/saveSignal", 1, [sig]() {
+        Library::saveSignal(sig, "benchmark");
+    });
+    add("Library/loadSignal/cold", 1, [sig]() {
+        Library::clearCache();
+        Signal loaded;
+        Library::loadSignal(loaded, "benchmark");
+    });
+    add("Library/loadSignal/cached", 1, [sig]() {
+        Signal loaded;
+        Library::loadSignal(loaded, "benchmark");
+    });
+    for (auto ext : {"wav", "csv", "json"}) {
+        std::string path = Library::getLibraryDirectory() + "benchmark." + ext;
+        add(std::string("Library/export/") + ext, 1, [sig, path]() {
+            Library::exportSignal(sig, path);
+        });
+        if (std::string(ext) == "csv")
+            continue; // CSV import isn't supported
+        add(std::string("Library/import/") + ext, 1, [sig, path]() {
+            Signal imported;
+            Library::importSignal(imported, path);
+        });
     }
-    display(toc(), n, sum, "Expression");
-   
-    sum = 0;
-    tic();
-    for (int i = 0; i < n; ++i) {
-        auto t = i * lenN;
-        sum += std::sin(TWO_PI * 175 * t + 2 * std::sin(2.0f * PI * 10 * t)) * env.sample(t);
+}
+
+Result measure(const Benchmark& b, double minTime, int repetitions) {
+    b.run(); // warm up
+    // grow the batch until it takes a measurable amount of time
+    std::uint64_t batch = 1;
+    double elapsed = 0;
+    while (true) {
+        auto start = Clock::now();
+        for (std::uint64_t i = 0; i < batch; ++i)
+            b.run();
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (elapsed >= minTime / 10 || batch >= (1ull << 30))
+            break;
+        batch *= 2;
     }
-    display(toc(), n, sum, "Best Case");  
-
-    sum = 0;
-    tic();
-    for (int i = 0; i < n; ++i) {
-        sig = Sine(i) * Saw(i) * Envelope(5);
-        auto t = i * lenN / n;
-        sum += sig.sample(t);
+    std::uint64_t iterations = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(batch * (minTime / std::max(elapsed, 1e-9))));
+    std::vector<double> times;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = Clock::now();
+        for (std::uint64_t i = 0; i < iterations; ++i)
+            b.run();
+        times.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (iterations * b.items));
     }
-    display(toc(), n, sum, "Allocation");
+    std::sort(times.begin(), times.end());
+    double ns = times[times.size() / 2];
+    return {b.name, iterations, ns, 1e9 / ns};
+}
+
+std::string escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
 
+void writeJson(const std::vector<Result>& results, const std::string& path) {
+    std::ofstream file(path);
+    file << "{\n  \"context\": {\n";
+    file << "    \"library\": \"syntacts\",\n";
+    file << "    \"version\": \"" << SYNTACTS_VERSION_MAJOR << "." << SYNTACTS_VERSION_MINOR << "." << SYNTACTS_VERSION_PATCH << "\",\n";
+    file << "    \"block_size\": " << SYNTACTS_BLOCK_SIZE << "\n  },\n";
+    file << "  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        auto& r = results[i];
+        file << "    {\"name\": \"" << escape(r.name) << "\", \"run_type\": \"aggregate\", \"aggregate_name\": \"median\", "
+             << "\"iterations\": " << r.iterations << ", \"real_time\": " << r.ns << ", \"cpu_time\": " << r.ns << ", "
+             << "\"time_unit\": \"ns\", \"items_per_second\": " << r.itemsPerSecond << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char const *argv[])
+{
+    std::string filter, json;
+    double minTime  = 0.2;
+    int repetitions = 3;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--filter") && i + 1 < argc)
+            filter = argv[++i];
+        else if (!std::strcmp(argv[i], "--json") && i + 1 < argc)
+            json = argv[++i];
+        else if (!std::strcmp(argv[i], "--min-time") && i + 1 < argc)
+            minTime = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--repetitions") && i + 1 < argc)
+            repetitions = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::cout << "usage: benchmark [--filter substring] [--json file] [--min-time seconds] [--repetitions n]" << std::endl;
+            return 1;
+        }
+    }
+
+    registerSignals();
+    registerCurves();
+    registerSequences();
+    registerMixer();
+    registerLibrary();
+
+    std::vector<Result> results;
+    std::printf("%-40s %14s %16s %14s\n", "Benchmark", "Time/Item (ns)", "Items/s", "Iterations");
+    for (auto& b : registry()) {
+        if (!filter.empty() && b.name.find(filter) == std::string::npos)
+            continue;
+        auto r = measure(b, minTime, repetitions);
+        std::printf("%-40s %14.2f %16.4g %14llu\n", r.name.c_str(), r.ns, r.itemsPerSecond, (unsigned long long)r.iterations);
+        results.push_back(r);
+    }
+    if (!json.empty())
+        writeJson(results, json);
     return 0;
 }
@@ -0,0 +1,60 @@
+#include <syntacts>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+// Measures output latency for a range of buffer sizes so it can be tuned per rig.
+// Usage: latency [device index] [sample rate] [suggested latency (s)]
+//
+// For each buffer size, reports:
+//  - reported: output latency from the stream (callback to DAC)
+//  - command:  time from Session::play until the audio thread has rendered the voice
+//  - total:    command + reported, an estimate of play() to sound at the DAC
+// A hardware loopback is needed to verify the DAC side; this measures what software can see.
+
+using namespace tact;
+using Clock = std::chrono::high_resolution_clock;
+
+int main(int argc, char const *argv[])
+{
+    int index          = argc > 1 ? std::atoi(argv[1]) : -1;
+    double sampleRate  = argc > 2 ? std::atof(argv[2]) : 0;
+    double latency     = argc > 3 ? std::atof(argv[3]) : 0;
+    int trials         = 50;
+
+    Session session;
+    if (index == -1)
+        index = session.getDefaultDevice().index;
+    auto& device = session.getAvailableDevices().at(index);
+    std::cout << " Device: " << device.name << " (" << device.apiName << ")" << std::endl;
+
+    for (int frames : {0, 32, 64, 128, 256, 512, 1024}) {
+        int result = session.open(index, 1, sampleRate, frames, latency);
+        if (result != SyntactsError_NoError) {
+            std::cout << std::endl << " Frames: " << frames << " failed to open (" << result << ")" << std::endl;
+            continue;
+        }
+        std::vector<double> command;
+        for (int i = 0; i < trials; ++i) {
+            auto start = Clock::now();
+            auto voice = session.play(0, Scalar(0) * Envelope(0.1));
+            while (!session.isPlaying(voice) && std::chrono::duration<double>(Clock::now() - start).count() < 1) { }
+            command.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+            session.stop(voice);
+            sleep(0.01);
+        }
+        std::sort(command.begin(), command.end());
+        double reported = session.getLatency();
+        double median   = command[command.size() / 2];
+        std::cout << std::endl;
+        std::cout << " Frames:   " << (frames == 0 ? "host" : std::to_string(frames)) << std::endl;
+        std::cout << " Reported: " << reported * 1000 << " ms" << std::endl;
+        std::cout << " Command:  " << median * 1000 << " ms median, " << command.back() * 1000 << " ms max" << std::endl;
+        std::cout << " Total:    " << (median + reported) * 1000 << " ms" << std::endl;
+        std::cout << " CPU Load: " << session.getCpuLoad() << std::endl;
+        session.close();
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+## usage:
+# 1) run the benchmark target of two builds with JSON output, e.g.:
+#    benchmark --json baseline.json
+#    benchmark --json contender.json
+# 2) run this script to compare them, e.g.:
+#    python compare_benchmarks.py baseline.json contender.json
+#    python compare_benchmarks.py baseline.json contender.json --threshold 5
+#
+# Prints the change in time per item for every benchmark in both files and exits with 1 if
+# any benchmark got slower by more than the threshold (percent, default 10), so it can gate CI.
+
+import sys
+import json
+import argparse
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    results = {}
+    for b in data["benchmarks"]:
+        # keep medians when a file has Google Benchmark style repetitions
+        if b.get("run_type") == "aggregate" and b.get("aggregate_name") != "median":
+            continue
+        results[b["name"]] = b["real_time"]
+    return results
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two Syntacts benchmark JSON files.")
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=10, help="percent slowdown flagged as a regression")
+    args = parser.parse_args()
+
+    baseline  = load(args.baseline)
+    contender = load(args.contender)
+
+    regressions = []
+    width = max([len(n) for n in baseline] + [9])
+    print("%-*s %14s %14s %9s" % (width, "Benchmark", "Baseline (ns)", "Contender (ns)", "Change"))
+    for name, old in baseline.items():
+        if name not in contender:
+            continue
+        new = contender[name]
+        change = (new - old) / old * 100 if old > 0 else 0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions.append(name)
+        elif change < -args.threshold:
+            flag = "  improved"
+        print("%-*s %14.2f %14.2f %+8.1f%%%s" % (width, name, old, new, change, flag))
+
+    missing = [n for n in baseline if n not in contender]
+    added   = [n for n in contender if n not in baseline]
+    if missing:
+        print("\nOnly in baseline: " + ", ".join(missing))
+    if added:
+        print("\nOnly in contender: " + ", ".join(added))
+
+    if regressions:
+        print("\n%d regression(s) over %g%%: %s" % (len(regressions), args.threshold, ", ".join(regressions)))
+        sys.exit(1)
+    print("\nNo regressions over %g%%" % args.threshold)
+
+if __name__ == "__main__":
+    main()
@@ -65,6 +65,48 @@ namespace Syntacts
         AudioScienceHPI = 14
     }
 
+    /// <summary>Determines which voice is replaced when a channel has no free voices.</summary>
+    public enum VoiceStealing {
+        Oldest         = 0,
+        Quietest       = 1,
+        LowestPriority = 2,
+        None           = 3
+    }
+
+    /// <summary>Identifies a single signal started with Session.PlayVoice.</summary>
+    public struct Voice {
+        public Voice(long handle) { this.handle = handle; }
+        /// <summary>The channel the signal was played on.</summary>
+        public int channel { get { return valid ? (int)(handle >> 32) : -1; } }
+        /// <summary>The error returned when playing the signal, if any.</summary>
+        public int error { get { return valid ? 0 : (int)handle; } }
+        /// <summary>True if the signal was played without error.</summary>
+        public bool valid { get { return handle > 0; } }
+        public long handle;
+    }
+
+    /// <summary>Optional processing applied to a channel's mixed output before it is sent to the device.</summary>
+    public class OutputStage {
+        public bool   dcBlocker   = false; ///< remove DC offset with a first order high pass filter
+        public double dcCutoff    = 5;     ///< DC blocker cutoff frequency in Hz
+        public bool   eq          = false; ///< apply a peaking EQ (e.g. a cut to flatten an actuator's resonance)
+        public double eqFrequency = 250;   ///< EQ center frequency in Hz
+        public double eqGain      = 0;     ///< EQ gain in dB
+        public double eqQ         = 1;     ///< EQ quality factor
+        public bool   limiter     = false; ///< apply a look-ahead peak limiter (delays output by lookAhead)
+        public double threshold   = 1;     ///< limiter ceiling between 0 and 1
+        public double lookAhead   = 0.005; ///< limiter look-ahead time in seconds
+        public double release     = 0.05;  ///< limiter release time in seconds
+        public bool   softClip    = false; ///< saturate smoothly toward +/-1 rather than hard clipping
+    }
+
+    /// <summary>Distribution of durations measured on the audio thread. Bin i counts durations in [2^i, 2^(i+1)) microseconds.</summary>
+    public class Histogram {
+        public long[] counts = new long[16]; ///< durations per bin
+        public double mean = 0;              ///< mean duration in seconds
+        public double max  = 0;              ///< longest duration in seconds
+    }
+
     /// <summary>Contains information about a specific audio device.</summary>
     public class Device {
 
@@ -149,6 +191,12 @@ namespace Syntacts
             return Dll.Session_open3(handle, index, channelCount, sampleRate);
         }
 
+        /// <summary>Opens a specific device by index with a specified number of channels, sample rate, frames per buffer, and suggested latency in seconds (0 uses the defaults).</summary>
+        public int Open(int index, int channelCount, double sampleRate, int framesPerBuffer, double latency = 0)
+        {
+            return Dll.Session_open6(handle, index, channelCount, sampleRate, framesPerBuffer, latency);
+        }
+
         /// <summary>Opens a specific device with its max channels and default sample rate.</summary>
         public int Open(Device device)
         {
@@ -161,6 +209,30 @@ namespace Syntacts
             return Dll.Session_open3(handle, device.index, channelCount, sampleRate);
         }
 
+        /// <summary>Opens a specific device with a specified number of channels, sample rate, frames per buffer, and suggested latency in seconds (0 uses the defaults).</summary>
+        public int Open(Device device, int channelCount, double sampleRate, int framesPerBuffer, double latency = 0)
+        {
+            return Dll.Session_open6(handle, device.index, channelCount, sampleRate, framesPerBuffer, latency);
+        }
+
+        /// <summary>Opens a native JACK client with one port per channel (0 for one per physical port). Requires a library built with SYNTACTS_USE_JACK.</summary>
+        public int OpenJack(int channelCount = 0, string clientName = "Syntacts", bool connect = true)
+        {
+            return Dll.Session_openJack(handle, channelCount, clientName, connect);
+        }
+
+        /// <summary>Opens an offline Session with no device, which only produces audio when Render is called.</summary>
+        public int OpenOffline(int channelCount, double sampleRate = 48000)
+        {
+            return Dll.Session_openOffline(handle, channelCount, sampleRate);
+        }
+
+        /// <summary>Renders frames of every channel of an offline Session into buffer (channelCount * frames samples, one channel after another).</summary>
+        public int Render(float[] buffer, int frames)
+        {
+            return Dll.Session_render(handle, buffer, frames);
+        }
+
         /// <summary>Closes the currently opened device.</summary>
         public int Close()
         {
@@ -173,6 +245,46 @@ namespace Syntacts
             return Dll.Session_play(handle, channel, signal.handle);
         }
 
+        /// <summary>Plays a signal on the specified channel with a priority used by VoiceStealing.LowestPriority.</summary>
+        public int Play(int channel, Signal signal, int priority)
+        {
+            return Dll.Session_play2(handle, channel, signal.handle, priority);
+        }
+
+        /// <summary>Plays a signal on the specified channel and returns a Voice that controls only that signal.</summary>
+        public Voice PlayVoice(int channel, Signal signal, int priority = 0)
+        {
+            return new Voice(Dll.Session_playVoice(handle, channel, signal.handle, priority));
+        }
+
+        /// <summary>Stops a single voice, leaving other voices on its channel playing.</summary>
+        public int Stop(Voice voice)
+        {
+            return Dll.Session_stopVoice(handle, voice.handle);
+        }
+
+        /// <summary>Sets the volume of a single voice (multiplied by its channel's volume).</summary>
+        public int SetVolume(Voice voice, double volume)
+        {
+            return Dll.Session_setVoiceVolume(handle, voice.handle, volume);
+        }
+
+        /// <summary>Sets the pitch of a single voice (multiplied by its channel's pitch).</summary>
+        public int SetPitch(Voice voice, double pitch)
+        {
+            return Dll.Session_setVoicePitch(handle, voice.handle, pitch);
+        }
+
+        /// <summary>Returns true if a voice is still playing.</summary>
+        public bool IsPlaying(Voice voice) {
+            return Dll.Session_isVoicePlaying(handle, voice.handle);
+        }
+
+        /// <summary>Gets the time of a voice in seconds, or 0 if it isn't playing.</summary>
+        public double GetTime(Voice voice) {
+            return Dll.Session_getVoiceTime(handle, voice.handle);
+        }
+
         /// <summary>Plays a signal on all available channels of the current device.</summary>
         public int PlayAll(Signal signal)
         {
@@ -231,6 +343,12 @@ namespace Syntacts
             return Dll.Session_setVolume(handle, channel, volume);
         }
 
+        /// <summary>Sets the volumes of several channels at once, so they change within the same buffer.</summary>
+        public int SetVolumes(int[] channels, double[] volumes)
+        {
+            return Dll.Session_setVolumes(handle, channels, volumes, Math.Min(channels.Length, volumes.Length));
+        }
+
         /// <summary>Gets the volume on the specified channel of the current device.</summary>
         public double GetVolume(int channel)
         {
@@ -254,6 +372,42 @@ namespace Syntacts
             return Dll.Session_getLevel(handle, channel);
         }
 
+        /// <summary>Gets the number of voices currently playing on the specified channel.</summary>
+        public int GetVoiceCount(int channel) {
+            return Dll.Session_getVoiceCount(handle, channel);
+        }
+
+        /// <summary>Sets the maximum number of simultaneous voices per channel.</summary>
+        public int SetMaxVoices(int voices) {
+            return Dll.Session_setMaxVoices(handle, voices);
+        }
+
+        /// <summary>The maximum number of simultaneous voices per channel.</summary>
+        public int maxVoices
+        {
+            get { return Dll.Session_getMaxVoices(handle); }
+        }
+
+        /// <summary>The policy used to replace a voice when a channel has no free voices.</summary>
+        public VoiceStealing voiceStealing
+        {
+            get { return (VoiceStealing)Dll.Session_getVoiceStealing(handle); }
+            set { Dll.Session_setVoiceStealing(handle, (int)value); }
+        }
+
+        /// <summary>Sets the output stage of a channel, applied in order DC blocker, EQ, limiter, soft clip.</summary>
+        public int SetOutputStage(int channel, OutputStage stage) {
+            return Dll.Session_setOutputStage(handle, channel, stage.dcBlocker, stage.dcCutoff, stage.eq, stage.eqFrequency, stage.eqGain, stage.eqQ,
+                                              stage.limiter, stage.threshold, stage.lookAhead, stage.release, stage.softClip);
+        }
+
+        /// <summary>The length in seconds of the ramps that fade voices in and out to prevent clicks (0 disables).</summary>
+        public double fadeTime
+        {
+            get { return Dll.Session_getFadeTime(handle); }
+            set { Dll.Session_setFadeTime(handle, value); }
+        }
+
         /// <summary>Gets info for the currently opened device.</summary>
         public Device currentDevice
         {
@@ -293,6 +447,59 @@ namespace Syntacts
             get { return Dll.Session_getCpuLoad(handle); }
         }
 
+        /// <summary>The actual output latency in seconds reported by the open stream.</summary>
+        public double latency
+        {
+            get { return Dll.Session_getLatency(handle); }
+        }
+
+        /// <summary>The time in seconds of the audio clock, used to timestamp Spatializer waypoints.</summary>
+        public double time
+        {
+            get { return Dll.Session_getTime(handle); }
+        }
+
+        /// <summary>Gets timing of the audio callback (channel -1) or of rendering a single channel.</summary>
+        public Histogram GetCallbackStats(int channel = -1)
+        {
+            Histogram h = new Histogram();
+            Dll.Session_getCallbackStats(handle, channel, out h.mean, out h.max, h.counts);
+            return h;
+        }
+
+        /// <summary>Commands waiting at the start of the most recent callback.</summary>
+        public int queueDepth
+        {
+            get { return Dll.Session_getQueueDepth(handle); }
+        }
+
+        /// <summary>Most commands waiting at the start of any callback.</summary>
+        public int queueDepthMax
+        {
+            get { return Dll.Session_getQueueDepthMax(handle); }
+        }
+
+        /// <summary>Buffer underflows/overflows reported by the host.</summary>
+        public long xrunCount
+        {
+            get { return Dll.Session_getXrunCount(handle); }
+        }
+
+        /// <summary>Gets the times in seconds since the Session opened of the most recent xruns (up to 32), oldest first.</summary>
+        public double[] GetXrunTimes()
+        {
+            double[] times = new double[32];
+            int n = Dll.Session_getXrunTimes(handle, times, times.Length);
+            Array.Resize(ref times, n);
+            return times;
+        }
+
+        /// <summary>Clears all callback, queue, and xrun stats.</summary>
+        public void ResetStats()
+        {
+            Dll.Session_resetStats(handle);
+        }
+
         /// <summary>True if the Session Handle is currently valid.</summary>
         public bool valid
         {
@@ -339,9 +546,11 @@ namespace Syntacts
     /// <summary>A 2D Spatializer point.</summary>
     [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
     public struct Point {
-        public Point(double x, double y) { this.x = x; this.y = y; }
+        public Point(double x, double y) { this.x = x; this.y = y; this.z = 0; }
+        public Point(double x, double y, double z) { this.x = x; this.y = y; this.z = z; }
         public double x;
         public double y;
+        public double z;
     }
 
     /// <summary>Types of supported interpolatin curves for Spatializer dropoff.</summary>
@@ -382,13 +591,27 @@ namespace Syntacts
 
         /// <summary>Set the position of a channel. The channel will be added if it's not already in the Spatializer.</summary>
         public void SetPosition(int channel, Point p) {
-            Dll.Spatializer_setPosition(handle, channel, p.x, p.y);
+            Dll.Spatializer_setPosition3(handle, channel, p.x, p.y, p.z);
+        }
+
+        /// <summary>Sets the positions of several channels with a single update. Channels will be added if they're not already in the Spatializer.</summary>
+        public void SetPositions(int[] channels, Point[] positions) {
+            int n = Math.Min(channels.Length, positions.Length);
+            double[] x = new double[n];
+            double[] y = new double[n];
+            double[] z = new double[n];
+            for (int i = 0; i < n; ++i) {
+                x[i] = positions[i].x;
+                y[i] = positions[i].y;
+                z[i] = positions[i].z;
+            }
+            Dll.Spatializer_setPositions(handle, channels, x, y, z, n);
         }
 
         /// <summary>Gets the position of a channel if it is in the Spatializer.</summary>
         public Point GetPosition(int channel) {
             Point p = new Point();
-            Dll.Spatializer_getPosition(handle, channel, ref p.x, ref p.y);
+            Dll.Spatializer_getPosition3(handle, channel, ref p.x, ref p.y, ref p.z);
             return p;
         }
 
@@ -427,6 +650,58 @@ namespace Syntacts
             Dll.Spatializer_update(handle);
         }
 
+        /// <summary>In Mixer mode, queues a target waypoint at a time on the Session clock (see Session.time).</summary>
+        public void AddWaypoint(double time, double x, double y, double z = 0) {
+            Dll.Spatializer_addWaypoint(handle, time, x, y, z);
+        }
+
+        /// <summary>In Mixer mode, queues a target waypoint at a time on the Session clock (see Session.time).</summary>
+        public void AddWaypoint(double time, Point p) {
+            Dll.Spatializer_addWaypoint(handle, time, p.x, p.y, p.z);
+        }
+
+        /// <summary>In Mixer mode, moves the target along x(t), y(t), z(t), where t is 0 when the path starts playing.</summary>
+        public void SetPath(Signal x, Signal y, Signal z) {
+            Dll.Spatializer_setPath(handle, x.handle, y.handle, z.handle);
+        }
+
+        /// <summary>Adds a target that plays its own Signal on the channels within its radius. Returns its id.</summary>
+        public int AddTarget(Point p, Signal signal, double radius = 0.25, Curve rollOff = Curve.Linear, double volume = 1) {
+            return Dll.Spatializer_addTarget(handle, p.x, p.y, p.z, signal.handle, radius, (int)rollOff, volume);
+        }
+
+        /// <summary>Moves an added target.</summary>
+        public void MoveTarget(int id, Point p) {
+            Dll.Spatializer_moveTarget(handle, id, p.x, p.y, p.z);
+        }
+
+        /// <summary>Sets the radius of an added target.</summary>
+        public void SetTargetRadius(int id, double r) {
+            Dll.Spatializer_setTargetRadius(handle, id, r);
+        }
+
+        /// <summary>Sets the volume of an added target.</summary>
+        public void SetTargetVolume(int id, double volume) {
+            Dll.Spatializer_setTargetVolume(handle, id, volume);
+        }
+
+        /// <summary>Removes an added target and stops its Signal.</summary>
+        public void RemoveTarget(int id) {
+            Dll.Spatializer_removeTarget(handle, id);
+        }
+
+        /// <summary>Removes and stops all added targets.</summary>
+        public void ClearTargets() {
+            Dll.Spatializer_clearTargets(handle);
+        }
+
+        /// <summary>Gets the ids of all added targets.</summary>
+        public int[] GetTargets() {
+            int[] ids = new int[Dll.Spatializer_getTargets(handle, null, 0)];
+            Dll.Spatializer_getTargets(handle, ids, ids.Length);
+            return ids;
+        }
+
         /// <summary>Finalizer.</summary>
         ~Spatializer()
         {
@@ -455,10 +730,10 @@ namespace Syntacts
             get
             {
                 Point p = new Point();
-                Dll.Spatializer_getTarget(handle, ref p.x, ref p.y);
+                Dll.Spatializer_getTarget3(handle, ref p.x, ref p.y, ref p.z);
                 return p;
             }
-            set { Dll.Spatializer_setTarget(handle, value.x, value.y);}
+            set { Dll.Spatializer_setTarget3(handle, value.x, value.y, value.z);}
         }
 
         /// <summary>The Spatializer target radius.</summary>
@@ -501,6 +776,20 @@ namespace Syntacts
             set { Dll.Spatializer_setPitch(handle, value); }
         }
 
+        /// <summary>Where channel gains are computed.</summary>
+        public enum Mode {
+            /// <summary>Update computes gains on the calling thread, which channels ramp to once per buffer.</summary>
+            Control = 0,
+            /// <summary>Positions and roll-off live in the Session mixer, which computes gains every sample.</summary>
+            Mixer = 1
+        }
+
+        /// <summary>Where channel gains are computed (Control by default).</summary>
+        public Mode mode {
+            get { return (Mode)Dll.Spatializer_getMode(handle); }
+            set { Dll.Spatializer_setMode(handle, (int)value); }
+        }
+
         /// <summary>Enable/disable automatic updating of pitch/volume of all channels when Spatializer target or channels change (enabled by default).</summary>
         public bool autoUpdate {
             set { Dll.Spatializer_autoUpdate(handle, value); }
@@ -776,11 +1065,47 @@ namespace Syntacts
         { }
     }
 
-    /// <summary>A signal that returns the evaluation of an expression f(t).</summary>
+    /// <summary>A signal that generates pink (1/f) noise.</summary>
+    public class PinkNoise : Signal {
+        public PinkNoise() :
+            base(Dll.PinkNoise_create())
+        { }
+    }
+
+    /// <summary>A signal that generates brown (1/f^2) noise.</summary>
+    public class BrownNoise : Signal {
+        public BrownNoise() :
+            base(Dll.BrownNoise_create())
+        { }
+    }
+
+    /// <summary>A signal that generates noise with no content above a bandwidth in Hz.</summary>
+    public class BandLimitedNoise : Signal {
+        public BandLimitedNoise(double bandwidth) :
+            base(Dll.BandLimitedNoise_create(bandwidth))
+        { }
+    }
+
+    /// <summary>A signal that returns the evaluation of an expression f(t). Variables must be declared, either by SetVariable or in the expression (e.g. "var amp; amp*sin(2*pi*100*t)").</summary>
     public class Expression : Signal {
         public Expression(string expr) :
             base(Dll.Expression_create(expr))
         { }
+
+        /// <summary>Sets a variable in the expression, declaring it if needed. Reaches copies already playing only if ShareVariables was called before they were made.</summary>
+        public bool SetVariable(string name, double value) {
+            return Dll.Expression_setVariable(handle, name, value);
+        }
+
+        /// <summary>Gets the current value of a variable in the expression.</summary>
+        public double GetVariable(string name) {
+            return Dll.Expression_getVariable(handle, name);
+        }
+
+        /// <summary>If true, copies made from now on (e.g. by playing the Expression) share its variables, so SetVariable reaches them while they play.</summary>
+        public void ShareVariables(bool share = true) {
+            Dll.Expression_shareVariables(handle, share);
+        }
     }
 
     /// <summary>A Signal defined by an array of recorded samples (used internally for Library.ImportSignal).</summary>
@@ -818,6 +1143,22 @@ namespace Syntacts
         { }
     }
 
+    /// <summary>Filter response types.</summary>
+    public enum FilterType {
+        LowPass  = 0,
+        HighPass = 1,
+        BandPass = 2,
+        Notch    = 3
+    }
+
+    /// <summary>A Signal which filters another Signal with a cascade of biquad sections (order 2 to 8).</summary>
+    public class Filter : Signal
+    {
+        public Filter(Signal signal, FilterType type, double frequency, double q = 0.7071, int order = 2) :
+            base(Dll.Filter_create(signal.handle, (int)type, frequency, q, order))
+        { }
+    }
+
     ///////////////////////////////////////////////////////////////////////////
     // ENVELOPE
     ///////////////////////////////////////////////////////////////////////////
@@ -990,6 +1331,21 @@ namespace Syntacts
             return Dll.Library_deleteSignal(name);
         }
 
+        /// <summary>Saves a Spatializer's channel layout and settings to the global Syntacts library.<summary>
+        public static bool SaveSpatializer(Spatializer spatializer, string name) {
+            return Dll.Library_saveSpatializer(spatializer.handle, name);
+        }
+
+        /// <summary>Loads a Spatializer's channel layout and settings from the global Syntacts library.<summary>
+        public static bool LoadSpatializer(Spatializer spatializer, string name) {
+            return Dll.Library_loadSpatializer(spatializer.handle, name);
+        }
+
+        /// <summary>Erases a Spatializer from the global Syntacts library if it exists.<summary>
+        public static bool DeleteSpatializer(string name) {
+            return Dll.Library_deleteSpatializer(name);
+        }
+
         /// <summary>Saves a Signal as a specified file format.<summary>
         public static bool ExportSignal(Signal signal, string filePath, FileFormat format = FileFormat.Auto, int sampleRate = 48000, double maxLength = 60) {
             return Dll.Library_exportSignal(signal.handle, filePath, (int)format, sampleRate, maxLength);
@@ -1002,6 +1358,27 @@ namespace Syntacts
                 return false;
             return true;
         }
+
+        /// <summary>Loads a library Signal into the cache in the background so later loads are served from memory.<summary>
+        public static void PrefetchSignal(string name) {
+            Dll.Library_prefetchSignal(name);
+        }
+
+        /// <summary>Sets the maximum serialized size in bytes the Signal cache may hold.<summary>
+        public static void SetCacheCapacity(long bytes) {
+            Dll.Library_setCacheCapacity(bytes);
+        }
+
+        /// <summary>Removes all Signals from the Signal cache.<summary>
+        public static void ClearCache() {
+            Dll.Library_clearCache();
+        }
+
+        /// <summary>Number of Signal loads served from the cache.<summary>
+        public static long cacheHits { get { return Dll.Library_cacheHits(); } }
+
+        /// <summary>Number of Signal loads which deserialized from disk.<summary>
+        public static long cacheMisses { get { return Dll.Library_cacheMisses(); } }
     }
 
     ///////////////////////////////////////////////////////////////////////////
@@ -1036,12 +1413,34 @@ namespace Syntacts
         [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
         public static extern int Session_open5(Handle session, string name, int api);
         [DllImport("syntacts_c")]
+        public static extern int Session_open6(Handle session, int index, int channelCount, double sampleRate, int framesPerBuffer, double latency);
+        [DllImport("syntacts_c")]
+        public static extern int Session_openJack(Handle session, int channelCount, string clientName, bool connect);
+        [DllImport("syntacts_c")]
+        public static extern int Session_openOffline(Handle session, int channelCount, double sampleRate);
+        [DllImport("syntacts_c")]
+        public static extern int Session_render(Handle session, float[] buffer, int frames);
+        [DllImport("syntacts_c")]
         public static extern int Session_close(Handle session);
         [DllImport("syntacts_c")]
         public static extern bool Session_isOpen(Handle session);
         [DllImport("syntacts_c")]
         public static extern int Session_play(Handle session, int channel, Handle signal);
         [DllImport("syntacts_c")]
+        public static extern int Session_play2(Handle session, int channel, Handle signal, int priority);
+        [DllImport("syntacts_c")]
+        public static extern long Session_playVoice(Handle session, int channel, Handle signal, int priority);
+        [DllImport("syntacts_c")]
+        public static extern int Session_stopVoice(Handle session, long voice);
+        [DllImport("syntacts_c")]
+        public static extern int Session_setVoiceVolume(Handle session, long voice, double volume);
+        [DllImport("syntacts_c")]
+        public static extern int Session_setVoicePitch(Handle session, long voice, double pitch);
+        [DllImport("syntacts_c")]
+        public static extern bool Session_isVoicePlaying(Handle session, long voice);
+        [DllImport("syntacts_c")]
+        public static extern double Session_getVoiceTime(Handle session, long voice);
+        [DllImport("syntacts_c")]
         public static extern int Session_playAll(Handle session, Handle signal);
         [DllImport("syntacts_c")]
         public static extern int Session_stop(Handle session, int channel);
@@ -1062,6 +1461,8 @@ namespace Syntacts
         [DllImport("syntacts_c")]
         public static extern int Session_setVolume(Handle session, int channel, double volume);
         [DllImport("syntacts_c")]
+        public static extern int Session_setVolumes(Handle session, int[] channels, double[] volumes, int count);
+        [DllImport("syntacts_c")]
         public static extern double Session_getVolume(Handle session, int channel);
         [DllImport("syntacts_c")]
         public static extern int Session_setPitch(Handle session, int channel, double pitch);
@@ -1070,12 +1471,44 @@ namespace Syntacts
         [DllImport("syntacts_c")]
         public static extern double Session_getLevel(Handle session, int channel);
         [DllImport("syntacts_c")]
+        public static extern int Session_setMaxVoices(Handle session, int voices);
+        [DllImport("syntacts_c")]
+        public static extern int Session_getMaxVoices(Handle session);
+        [DllImport("syntacts_c")]
+        public static extern int Session_getVoiceCount(Handle session, int channel);
+        [DllImport("syntacts_c")]
+        public static extern void Session_setVoiceStealing(Handle session, int policy);
+        [DllImport("syntacts_c")]
+        public static extern int Session_getVoiceStealing(Handle session);
+        [DllImport("syntacts_c")]
+        public static extern int Session_setFadeTime(Handle session, double seconds);
+        [DllImport("syntacts_c")]
+        public static extern int Session_setOutputStage(Handle session, int channel, bool dcBlocker, double dcCutoff, bool eq, double eqFrequency, double eqGain, double eqQ, bool limiter, double threshold, double lookAhead, double release, bool softClip);
+        [DllImport("syntacts_c")]
+        public static extern double Session_getFadeTime(Handle session);
+        [DllImport("syntacts_c")]
         public static extern int Session_getChannelCount(Handle session);
         [DllImport("syntacts_c")]
         public static extern double Session_getSampleRate(Handle session);
         [DllImport("syntacts_c")]
         public static extern double Session_getCpuLoad(Handle session);
         [DllImport("syntacts_c")]
+        public static extern double Session_getLatency(Handle session);
+        [DllImport("syntacts_c")]
+        public static extern double Session_getTime(Handle session);
+        [DllImport("syntacts_c")]
+        public static extern void Session_getCallbackStats(Handle session, int channel, out double mean, out double max, long[] counts);
+        [DllImport("syntacts_c")]
+        public static extern int Session_getQueueDepth(Handle session);
+        [DllImport("syntacts_c")]
+        public static extern int Session_getQueueDepthMax(Handle session);
+        [DllImport("syntacts_c")]
+        public static extern long Session_getXrunCount(Handle session);
+        [DllImport("syntacts_c")]
+        public static extern int Session_getXrunTimes(Handle session, double[] times, int maxCount);
+        [DllImport("syntacts_c")]
+        public static extern void Session_resetStats(Handle session);
+        [DllImport("syntacts_c")]
         public static extern int Session_getCurrentDevice(Handle session);
         [DllImport("syntacts_c")]
         public static extern int Session_getDefaultDevice(Handle session);
@@ -1168,6 +1601,38 @@ namespace Syntacts
         public static extern void Spatializer_autoUpdate(Handle spat, bool enable);
         [DllImport("syntacts_c")]
         public static extern void Spatializer_update(Handle spat);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_setMode(Handle spat, int mode);
+        [DllImport("syntacts_c")]
+        public static extern int Spatializer_getMode(Handle spat);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_addWaypoint(Handle spat, double time, double x, double y, double z);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_setPath(Handle spat, Handle x, Handle y, Handle z);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_setPosition3(Handle spat, int channel, double x, double y, double z);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_getPosition3(Handle spat, int channel, ref double x, ref double y, ref double z);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_setTarget3(Handle spat, double x, double y, double z);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_getTarget3(Handle spat, ref double x, ref double y, ref double z);
+        [DllImport("syntacts_c")]
+        public static extern int Spatializer_addTarget(Handle spat, double x, double y, double z, Handle signal, double radius, int rollOff, double volume);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_moveTarget(Handle spat, int id, double x, double y, double z);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_setTargetRadius(Handle spat, int id, double r);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_setTargetVolume(Handle spat, int id, double volume);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_removeTarget(Handle spat, int id);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_clearTargets(Handle spat);
+        [DllImport("syntacts_c")]
+        public static extern int Spatializer_getTargets(Handle spat, int[] ids, int maxCount);
+        [DllImport("syntacts_c")]
+        public static extern void Spatializer_setPositions(Handle spat, int[] channels, double[] x, double[] y, double[] z, int count);
 
         [DllImport("syntacts_c")]
         public static extern void Signal_delete(Handle signal);
@@ -1250,8 +1715,20 @@ namespace Syntacts
         public static extern Handle Ramp_create2(double initial, double final, double duration);
         [DllImport("syntacts_c")]
         public static extern Handle Noise_create();
+        [DllImport("syntacts_c")]
+        public static extern Handle PinkNoise_create();
+        [DllImport("syntacts_c")]
+        public static extern Handle BrownNoise_create();
+        [DllImport("syntacts_c")]
+        public static extern Handle BandLimitedNoise_create(double bandwidth);
         [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
         public static extern Handle Expression_create(string expr);
+        [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool Expression_setVariable(Handle handle, string name, double value);
+        [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
+        public static extern double Expression_getVariable(Handle handle, string name);
+        [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
+        public static extern void Expression_shareVariables(Handle handle, bool share);
         [DllImport("syntacts_c")]
         public static extern Handle Samples_create(float[] samples, int nSamples, double sampleRate);
 
@@ -1261,6 +1738,8 @@ namespace Syntacts
         public static extern Handle Stretcher_create(Handle signal, double factor);
         [DllImport("syntacts_c")]
         public static extern Handle Reverser_create(Handle signal);
+        [DllImport("syntacts_c")]
+        public static extern Handle Filter_create(Handle signal, int type, double frequency, double q, int order);
 
         [DllImport("syntacts_c")]
         public static extern Handle Envelope_create(double duration, double amp);
@@ -1320,9 +1799,25 @@ namespace Syntacts
         [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
         public static extern bool Library_deleteSignal(string name);
         [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool Library_saveSpatializer(Handle spat, string name);
+        [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool Library_loadSpatializer(Handle spat, string name);
+        [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
+        public static extern bool Library_deleteSpatializer(string name);
+        [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
         public static extern bool Library_exportSignal(Handle signal, string filePath, int format, int sampleRate, double maxLength);
         [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
         public static extern Handle Library_importSignal(string filePath, int format, int sampleRate);
+        [DllImport("syntacts_c", CallingConvention = CallingConvention.Cdecl)]
+        public static extern void Library_prefetchSignal(string name);
+        [DllImport("syntacts_c")]
+        public static extern void Library_setCacheCapacity(long bytes);
+        [DllImport("syntacts_c")]
+        public static extern void Library_clearCache();
+        [DllImport("syntacts_c")]
+        public static extern long Library_cacheHits();
+        [DllImport("syntacts_c")]
+        public static extern long Library_cacheMisses();
 
         [DllImport("syntacts_c")]
         public static extern int Debug_sigMapSize();